@@ -0,0 +1,201 @@
+// benchdriver.cpp
+// Runs pagingwithpr over a grid of traces, level splits, -f and -b values
+// and records throughput and peak RSS for each run as CSV. With -c, each
+// configuration is also replayed with --concurrent on 1..N threads, every
+// thread replaying its own copy of the trace, to measure scaling.
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <ctime>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+using namespace std;
+
+struct RunResult {
+    bool ok = false;
+    unsigned long records = 0;
+    unsigned long hits = 0;
+    unsigned long misses = 0;
+    unsigned long replacements = 0;
+    double seconds = 0;
+    long peakRssKb = 0;
+};
+
+static void usage(const char* prog) {
+    cerr << "usage: " << prog << " -t trace [-t trace ...] [options] [-- extra simulator args]" << endl
+         << "  -s path       simulator binary (default ./pagingwithpr)" << endl
+         << "  -o file       CSV output (default stdout)" << endl
+         << "  -L \"bits\"     level split, repeatable (default \"20\", \"10 10\", \"8 8 4\")" << endl
+         << "  -f list       comma separated frame counts (default 999999,1000,100)" << endl
+         << "  -b list       comma separated NFU intervals (default 10,100)" << endl
+         << "  -r repeats    runs per configuration (default 1)" << endl
+         << "  -c list       comma separated --concurrent thread counts (default serial only)" << endl;
+}
+
+static vector<string> splitList(const string& list, char sep) {
+    vector<string> items;
+    stringstream ss(list);
+    string item;
+    while (getline(ss, item, sep)) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+static double nowSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Fork and exec the simulator with its stdout on a pipe, then parse the
+// summary and collect the child's peak RSS from wait4.
+static RunResult runOnce(const vector<string>& args) {
+    RunResult result;
+    int fds[2];
+    if (pipe(fds) != 0) return result;
+
+    double start = nowSeconds();
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return result;
+    }
+    if (pid == 0) {
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        vector<char*> argv;
+        for (const string& a : args) argv.push_back(const_cast<char*>(a.c_str()));
+        argv.push_back(nullptr);
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+
+    close(fds[1]);
+    string output;
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(fds[0], buf, sizeof(buf))) > 0) output.append(buf, n);
+    close(fds[0]);
+
+    int status = 0;
+    rusage usage;
+    wait4(pid, &status, 0, &usage);
+    result.seconds = nowSeconds() - start;
+    result.peakRssKb = usage.ru_maxrss;
+
+    stringstream lines(output);
+    string line;
+    while (getline(lines, line)) {
+        sscanf(line.c_str(), "Addresses processed: %lu", &result.records);
+        sscanf(line.c_str(), "Page hits: %lu, Misses: %lu, Page Replacements: %lu",
+               &result.hits, &result.misses, &result.replacements);
+    }
+    result.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0 && result.records > 0;
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    string sim = "./pagingwithpr";
+    string outFile;
+    vector<string> traces;
+    vector<string> levelSplits;
+    vector<string> frames = {"999999", "1000", "100"};
+    vector<string> intervals = {"10", "100"};
+    vector<string> extraArgs;
+    vector<string> threadCounts;
+    int repeats = 1;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--") {
+            for (i++; i < argc; i++) extraArgs.push_back(argv[i]);
+        } else if (i + 1 < argc && arg == "-s") {
+            sim = argv[++i];
+        } else if (i + 1 < argc && arg == "-o") {
+            outFile = argv[++i];
+        } else if (i + 1 < argc && arg == "-t") {
+            traces.push_back(argv[++i]);
+        } else if (i + 1 < argc && arg == "-L") {
+            levelSplits.push_back(argv[++i]);
+        } else if (i + 1 < argc && arg == "-f") {
+            frames = splitList(argv[++i], ',');
+        } else if (i + 1 < argc && arg == "-b") {
+            intervals = splitList(argv[++i], ',');
+        } else if (i + 1 < argc && arg == "-c") {
+            threadCounts = splitList(argv[++i], ',');
+        } else if (i + 1 < argc && arg == "-r") {
+            repeats = atoi(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (traces.empty() || repeats < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (levelSplits.empty()) levelSplits = {"20", "10 10", "8 8 4"};
+    // 0 stands for a plain serial run
+    if (threadCounts.empty()) threadCounts = {"0"};
+
+    ofstream file;
+    if (!outFile.empty()) {
+        file.open(outFile);
+        if (!file) {
+            cerr << "Unable to open " << outFile << endl;
+            return 1;
+        }
+    }
+    ostream& out = outFile.empty() ? cout : file;
+
+    string extra;
+    for (const string& a : extraArgs) extra += (extra.empty() ? "" : " ") + a;
+
+    out << "trace,levels,frames,interval,threads,extra_args,run,records,hits,misses,replacements,"
+        << "seconds,records_per_sec,ns_per_access,peak_rss_kb" << endl;
+
+    for (const string& trace : traces) {
+        for (const string& levels : levelSplits) {
+            for (const string& f : frames) {
+                for (const string& b : intervals) {
+                    for (const string& threads : threadCounts) {
+                        int copies = max(1, atoi(threads.c_str()));
+                        vector<string> args = {sim, "-f", f, "-b", b};
+                        if (threads != "0") args.push_back("--concurrent");
+                        args.insert(args.end(), extraArgs.begin(), extraArgs.end());
+                        for (int c = 0; c < copies; c++) args.push_back(trace);
+                        for (const string& bits : splitList(levels, ' ')) args.push_back(bits);
+
+                        for (int run = 0; run < repeats; run++) {
+                            RunResult r = runOnce(args);
+                            if (!r.ok) {
+                                cerr << "Run failed: " << trace << " [" << levels << "] -f " << f
+                                     << " -b " << b << " threads " << threads << endl;
+                                continue;
+                            }
+                            char metrics[128];
+                            snprintf(metrics, sizeof(metrics), "%.6f,%.0f,%.2f",
+                                     r.seconds, r.records / r.seconds, r.seconds * 1e9 / r.records);
+                            out << trace << ",\"" << levels << "\"," << f << "," << b << ","
+                                << threads << ",\"" << extra << "\"," << run << "," << r.records << ","
+                                << r.hits << "," << r.misses << "," << r.replacements << ","
+                                << metrics << "," << r.peakRssKb << endl;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
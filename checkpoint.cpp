@@ -0,0 +1,222 @@
+// checkpoint.cpp
+#include "checkpoint.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+static_assert(sizeof(CheckpointHeader) == 224, "checkpoint header layout");
+static_assert(sizeof(CheckpointLevel) == 12, "checkpoint level layout");
+static_assert(sizeof(CheckpointPage) == 24, "checkpoint page layout");
+
+static void collectLevels(const PageTable& pt, const Level* level, uint32_t prefix,
+                          vector<CheckpointLevel>& out) {
+    out.push_back({(uint32_t) level->depth, prefix, level->largeMapArray ? 1U : 0U});
+    if (!level->nextLevel) return;
+    for (unsigned int i = 0; i < pt.entryCount[level->depth]; i++) {
+        if (level->nextLevel[i]) {
+            collectLevels(pt, level->nextLevel[i], prefix | (i << pt.shiftAry[level->depth]), out);
+        }
+    }
+}
+
+bool writeCheckpoint(const PageTable& pt, const string& path) {
+    vector<CheckpointLevel> levels;
+    collectLevels(pt, pt.rootNode, 0, levels);
+
+    vector<CheckpointPage> pages;
+    pages.reserve(pt.loadedPagesCollection.size());
+    for (Map* map : pt.loadedPagesCollection) {
+        CheckpointPage page;
+        memset(&page, 0, sizeof(page));
+        page.lastAccessTime = map->lastAccessTime;
+        page.vpn = map->vpn;
+        page.frameNumber = map->frameNumber;
+        page.bitstring = map->bitstring;
+        page.flags = (map->large ? CHECKPOINT_PAGE_LARGE : 0) |
+                     (map->prefetched ? CHECKPOINT_PAGE_PREFETCHED : 0) |
+                     (pt.accessedPagesInInterval.count(map) ? CHECKPOINT_PAGE_ACCESSED : 0) |
+                     (map->dirty ? CHECKPOINT_PAGE_DIRTY : 0);
+        pages.push_back(page);
+    }
+    vector<int32_t> freeFrames(pt.freeFrames.begin(), pt.freeFrames.end());
+
+    CheckpointHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.levelCount = pt.levelCount;
+    for (int i = 0; i < pt.levelCount; i++) {
+        header.levelBits[i] = (uint8_t) __builtin_popcount(pt.bitMaskAry[i]);
+    }
+    header.numFrames = pt.numFrames;
+    header.nfuInterval = pt.nfuInterval;
+    header.nfuCounter = pt.nfuCounter;
+    header.framesUsed = pt.framesUsed;
+    header.accesses = pt.accesses;
+    header.pageHits = pt.pageHits;
+    header.pageFaults = pt.pageFaults;
+    header.pageReplacements = pt.pageReplacements;
+    header.largePageHits = pt.largePageHits;
+    header.promotions = pt.promotions;
+    header.demotions = pt.demotions;
+    header.migrations = pt.migrations;
+    header.prefetchIssued = pt.prefetchIssued;
+    header.prefetchUsed = pt.prefetchUsed;
+    header.prefetchEvicted = pt.prefetchEvicted;
+    header.ticks = pt.ticks;
+    header.nextAgingTick = pt.nextAgingTick;
+    header.dirtyWritebacks = pt.dirtyWritebacks;
+    header.reclaimed = pt.reclaimed;
+    header.residentFrameSum = pt.residentFrameSum;
+    header.clockHand = pt.clockHand;
+    header.levelRecords = levels.size();
+    header.pageRecords = pages.size();
+    header.freeFrameRecords = freeFrames.size();
+
+    string staging = path + ".tmp";
+    FILE* out = fopen(staging.c_str(), "wb");
+    if (!out) return false;
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1 &&
+              fwrite(levels.data(), sizeof(CheckpointLevel), levels.size(), out) == levels.size() &&
+              fwrite(pages.data(), sizeof(CheckpointPage), pages.size(), out) == pages.size() &&
+              fwrite(freeFrames.data(), sizeof(int32_t), freeFrames.size(), out) == freeFrames.size();
+    ok = fclose(out) == 0 && ok;
+    if (!ok || rename(staging.c_str(), path.c_str()) != 0) {
+        remove(staging.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Walk to the node at depth covering virtualAddress, creating any missing
+// nodes on the way.
+static Level* levelAt(PageTable& pt, unsigned int virtualAddress, int depth) {
+    Level* level = pt.rootNode;
+    for (int i = 0; i < depth; i++) {
+        Level*& next = level->nextLevel[pt.extractVPNIndex(virtualAddress, i)];
+        if (!next) next = new Level(i + 1, &pt);
+        level = next;
+    }
+    return level;
+}
+
+static string restore(PageTable& pt, const uint8_t* base, size_t length) {
+    CheckpointHeader header;
+    memcpy(&header, base, sizeof(header));
+    if (memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0 || header.version != CHECKPOINT_VERSION)
+        return "not a checkpoint";
+
+    bool sameLevels = header.levelCount == (uint32_t) pt.levelCount;
+    for (int i = 0; sameLevels && i < pt.levelCount; i++) {
+        sameLevels = header.levelBits[i] == __builtin_popcount(pt.bitMaskAry[i]);
+    }
+    if (!sameLevels) return "written for a different page table level split";
+    if (header.framesUsed < 0 || header.clockHand < 0 || (header.clockHand > 0 && header.clockHand >= header.framesUsed))
+        return "truncated or corrupt";
+    if (header.framesUsed > pt.numFrames)
+        return "uses " + to_string(header.framesUsed) + " frames, more than are available";
+
+    uint64_t expected = sizeof(header) + header.levelRecords * sizeof(CheckpointLevel) +
+                        header.pageRecords * sizeof(CheckpointPage) +
+                        header.freeFrameRecords * sizeof(int32_t);
+    if (expected != length) return "truncated or corrupt";
+
+    const CheckpointLevel* levels = reinterpret_cast<const CheckpointLevel*>(base + sizeof(header));
+    const CheckpointPage* pages = reinterpret_cast<const CheckpointPage*>(levels + header.levelRecords);
+    const int32_t* freeFrames = reinterpret_cast<const int32_t*>(pages + header.pageRecords);
+
+    for (uint64_t i = 0; i < header.levelRecords; i++) {
+        const CheckpointLevel& record = levels[i];
+        if (record.depth >= (uint32_t) pt.levelCount) return "truncated or corrupt";
+        Level* level = levelAt(pt, record.prefix, record.depth);
+        if (record.hasLarge) {
+            if ((int) record.depth != pt.levelCount - 2) return "truncated or corrupt";
+            pt.addLargeMaps(level);
+        }
+    }
+
+    // Every frame is held by at most one page or free-list entry
+    vector<bool> frameTaken(header.framesUsed, false);
+    unsigned int pageCount = 1U << (32 - pt.offset);
+    for (uint64_t i = 0; i < header.pageRecords; i++) {
+        const CheckpointPage& record = pages[i];
+        if (record.vpn >= pageCount || record.frameNumber < 0 || record.frameNumber >= header.framesUsed ||
+            frameTaken[record.frameNumber])
+            return "truncated or corrupt";
+        frameTaken[record.frameNumber] = true;
+
+        unsigned int virtualAddress = record.vpn << pt.offset;
+        Map* map;
+        if (record.flags & CHECKPOINT_PAGE_LARGE) {
+            Level* parent = levelAt(pt, virtualAddress, pt.levelCount - 2);
+            if (!parent->largeMapArray) return "truncated or corrupt";
+            map = &parent->largeMapArray[pt.extractVPNIndex(virtualAddress, pt.levelCount - 2)];
+        } else {
+            Level* leaf = levelAt(pt, virtualAddress, pt.levelCount - 1);
+            map = &leaf->mapArray[pt.extractVPNIndex(virtualAddress, pt.levelCount - 1)];
+            if (map->frameNumber == -1) leaf->mappedCount++;
+        }
+        map->frameNumber = record.frameNumber;
+        map->bitstring = record.bitstring;
+        map->lastAccessTime = record.lastAccessTime;
+        map->vpn = record.vpn;
+        map->prefetched = record.flags & CHECKPOINT_PAGE_PREFETCHED;
+        map->dirty = record.flags & CHECKPOINT_PAGE_DIRTY;
+        pt.addLoadedPage(map);
+        if (!pt.frameOwner.empty()) pt.frameOwner[record.frameNumber] = map;
+        if (record.flags & CHECKPOINT_PAGE_ACCESSED) {
+            pt.accessedPagesInInterval.insert(map);
+        }
+    }
+    for (uint64_t i = 0; i < header.freeFrameRecords; i++) {
+        int32_t frame = freeFrames[i];
+        if (frame < 0 || frame >= header.framesUsed || frameTaken[frame]) return "truncated or corrupt";
+        frameTaken[frame] = true;
+    }
+    pt.freeFrames.assign(freeFrames, freeFrames + header.freeFrameRecords);
+
+    pt.nfuCounter = header.nfuCounter;
+    pt.framesUsed = header.framesUsed;
+    pt.accesses = header.accesses;
+    pt.pageHits = header.pageHits;
+    pt.pageFaults = header.pageFaults;
+    pt.pageReplacements = header.pageReplacements;
+    pt.largePageHits = header.largePageHits;
+    pt.promotions = header.promotions;
+    pt.demotions = header.demotions;
+    pt.migrations = header.migrations;
+    pt.prefetchIssued = header.prefetchIssued;
+    pt.prefetchUsed = header.prefetchUsed;
+    pt.prefetchEvicted = header.prefetchEvicted;
+    pt.ticks = header.ticks;
+    pt.nextAgingTick = header.nextAgingTick;
+    pt.dirtyWritebacks = header.dirtyWritebacks;
+    pt.reclaimed = header.reclaimed;
+    pt.residentFrameSum = header.residentFrameSum;
+    pt.clockHand = (int) header.clockHand;
+    return "";
+}
+
+string loadCheckpoint(PageTable& pt, const string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return "cannot be opened";
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(CheckpointHeader)) {
+        close(fd);
+        return "not a checkpoint";
+    }
+    void* mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) return "cannot be mapped";
+
+    string problem = restore(pt, static_cast<const uint8_t*>(mapped), st.st_size);
+    munmap(mapped, st.st_size);
+    return problem;
+}
@@ -0,0 +1,93 @@
+// checkpoint.h
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstdint>
+#include <string>
+#include "pagetable.h"
+
+/*
+ * Snapshot of a PageTable (--checkpoint-every, --resume).
+ *
+ * A fixed header holding the configuration and counters is followed by
+ * three arrays of fixed-size records, read in place from an mmap:
+ *   levels - every Level node in preorder, located by depth and the
+ *            virtual address its first entry covers
+ *   pages  - every resident page in loadedPagesCollection order with its
+ *            frame, NFU bitstring and last access time
+ *   free   - the free frame list, bottom first
+ * accesses doubles as the trace offset to continue from.
+ */
+const char CHECKPOINT_MAGIC[8] = {'P', '2', 'C', 'K', 'P', 'T', '0', '1'};
+const uint32_t CHECKPOINT_VERSION = 3;
+
+const int CHECKPOINT_MAX_LEVELS = 32;
+
+struct CheckpointHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t levelCount;
+    uint8_t levelBits[CHECKPOINT_MAX_LEVELS];
+    int32_t numFrames;
+    int32_t nfuInterval;
+    int32_t nfuCounter;
+    int32_t framesUsed;
+    int64_t accesses;
+    int64_t pageHits;
+    int64_t pageFaults;
+    int64_t pageReplacements;
+    int64_t largePageHits;
+    int64_t promotions;
+    int64_t demotions;
+    int64_t migrations;
+    int64_t prefetchIssued;
+    int64_t prefetchUsed;
+    int64_t prefetchEvicted;
+    int64_t ticks;           // trace time reached, for --age-ticks
+    int64_t nextAgingTick;
+    int64_t dirtyWritebacks;
+    int64_t reclaimed;       // working-set mode
+    int64_t residentFrameSum;
+    int64_t clockHand;
+    uint64_t levelRecords;
+    uint64_t pageRecords;
+    uint64_t freeFrameRecords;
+};
+
+struct CheckpointLevel {
+    uint32_t depth;
+    uint32_t prefix;     // virtual address covered by entry 0
+    uint32_t hasLarge;   // the node carries superpage entries
+};
+
+const uint8_t CHECKPOINT_PAGE_LARGE = 1;
+const uint8_t CHECKPOINT_PAGE_PREFETCHED = 2;
+const uint8_t CHECKPOINT_PAGE_ACCESSED = 4;  // in accessedPagesInInterval
+const uint8_t CHECKPOINT_PAGE_DIRTY = 8;
+
+struct CheckpointPage {
+    int64_t lastAccessTime;
+    uint32_t vpn;
+    int32_t frameNumber;
+    uint16_t bitstring;
+    uint8_t flags;
+    uint8_t reserved[5];
+};
+
+/**
+ * @brief Write pt to path. The snapshot is written beside path and renamed
+ *        into place, so a crash never leaves a partial checkpoint.
+ * @return false if the file could not be written
+ */
+bool writeCheckpoint(const PageTable& pt, const std::string& path);
+
+/**
+ * @brief Load a snapshot into pt, which must be fresh and have the same
+ *        level split. Frame count, -b interval and superpages may differ
+ *        from the run that wrote it, to fork what-if continuations.
+ * @return empty on success, otherwise the reason the snapshot was rejected,
+ *         in which case pt may be partly loaded and should be discarded
+ */
+std::string loadCheckpoint(PageTable& pt, const std::string& path);
+
+#endif // CHECKPOINT_H
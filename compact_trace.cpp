@@ -0,0 +1,198 @@
+// compact_trace.cpp
+#include "compact_trace.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+static void putVarint(vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back((uint8_t) (value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t) value);
+}
+
+// Decode one varint from [p, end); false if it runs past end or is longer
+// than a 64-bit value allows.
+static inline bool getVarint(const uint8_t*& p, const uint8_t* end, uint64_t* value) {
+    uint64_t result = 0;
+    for (unsigned int shift = 0; shift < 64 && p < end; shift += 7) {
+        uint8_t byte = *p++;
+        result |= (uint64_t) (byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+static inline uint64_t zigzag(int64_t v) {
+    return ((uint64_t) v << 1) ^ (uint64_t) (v >> 63);
+}
+
+static inline int64_t unzigzag(uint64_t v) {
+    return (int64_t) (v >> 1) ^ -(int64_t) (v & 1);
+}
+
+static bool appendFile(FILE* from, FILE* to) {
+    rewind(from);
+    char buf[1 << 16];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), from)) > 0) {
+        if (fwrite(buf, 1, n, to) != n) return false;
+    }
+    return true;
+}
+
+bool writeCompactTrace(TraceSource* source, const string& path,
+                       unsigned int offsetBits, uint32_t flags,
+                       CompactTraceHeader* header) {
+    FILE* out = fopen(path.c_str(), "wb");
+    if (!out) return false;
+
+    // The VPN column streams straight into the output after a placeholder
+    // header; the optional columns are staged in temporary files and
+    // appended once the record count is known.
+    FILE* offsetTmp = (flags & COMPACT_HAS_OFFSETS) ? tmpfile() : nullptr;
+    FILE* reqtypeTmp = (flags & COMPACT_HAS_REQTYPE) ? tmpfile() : nullptr;
+
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, COMPACT_TRACE_MAGIC, sizeof(header->magic));
+    header->version = 1;
+    header->offsetBits = offsetBits;
+    header->flags = flags;
+
+    bool ok = fwrite(header, sizeof(*header), 1, out) == 1 &&
+              (!(flags & COMPACT_HAS_OFFSETS) || offsetTmp) &&
+              (!(flags & COMPACT_HAS_REQTYPE) || reqtypeTmp);
+
+    vector<p2AddrTr> block(TRACE_BLOCK_RECORDS);
+    vector<uint8_t> vpnBuf, offsetBuf, reqtypeBuf;
+    uint32_t offsetMask = offsetBits >= 32 ? 0xFFFFFFFFU : (1U << offsetBits) - 1;
+    uint32_t lastVpn = 0;
+    size_t n;
+
+    while (ok && (n = source->nextBlock(block.data(), block.size())) > 0) {
+        vpnBuf.clear();
+        offsetBuf.clear();
+        reqtypeBuf.clear();
+        for (size_t i = 0; i < n; i++) {
+            uint32_t vpn = offsetBits >= 32 ? 0 : block[i].addr >> offsetBits;
+            putVarint(vpnBuf, zigzag((int64_t) vpn - (int64_t) lastVpn));
+            lastVpn = vpn;
+            if (offsetTmp) putVarint(offsetBuf, block[i].addr & offsetMask);
+            if (reqtypeTmp) reqtypeBuf.push_back(block[i].reqtype);
+        }
+        header->records += n;
+        header->vpnBytes += vpnBuf.size();
+        header->offsetBytes += offsetBuf.size();
+        header->reqtypeBytes += reqtypeBuf.size();
+        ok = fwrite(vpnBuf.data(), 1, vpnBuf.size(), out) == vpnBuf.size() &&
+             (!offsetTmp || fwrite(offsetBuf.data(), 1, offsetBuf.size(), offsetTmp) == offsetBuf.size()) &&
+             (!reqtypeTmp || fwrite(reqtypeBuf.data(), 1, reqtypeBuf.size(), reqtypeTmp) == reqtypeBuf.size());
+    }
+
+    if (ok && offsetTmp) ok = appendFile(offsetTmp, out);
+    if (ok && reqtypeTmp) ok = appendFile(reqtypeTmp, out);
+    if (ok) {
+        rewind(out);
+        ok = fwrite(header, sizeof(*header), 1, out) == 1;
+    }
+
+    if (offsetTmp) fclose(offsetTmp);
+    if (reqtypeTmp) fclose(reqtypeTmp);
+    if (fclose(out) != 0) ok = false;
+    return ok;
+}
+
+CompactTraceSource* CompactTraceSource::open(const string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(CompactTraceHeader)) {
+        close(fd);
+        return nullptr;
+    }
+    void* mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) return nullptr;
+    madvise(mapped, st.st_size, MADV_SEQUENTIAL);
+
+    CompactTraceSource* source = new CompactTraceSource();
+    source->base = static_cast<const uint8_t*>(mapped);
+    source->length = st.st_size;
+    memcpy(&source->header, source->base, sizeof(CompactTraceHeader));
+
+    const CompactTraceHeader& h = source->header;
+    uint64_t expectedOffsetBytes = (h.flags & COMPACT_HAS_OFFSETS) ? h.offsetBytes : 0;
+    uint64_t expectedReqtypeBytes = (h.flags & COMPACT_HAS_REQTYPE) ? h.records : 0;
+    // Check each column against the bytes left rather than summing the
+    // sizes, which a corrupt header could make wrap around
+    uint64_t left = source->length - sizeof(CompactTraceHeader);
+    bool columnsFit = h.vpnBytes <= left && h.offsetBytes <= left - h.vpnBytes &&
+                      h.reqtypeBytes == left - h.vpnBytes - h.offsetBytes;
+    if (memcmp(h.magic, COMPACT_TRACE_MAGIC, sizeof(h.magic)) != 0 || h.version != 1 ||
+        h.offsetBits > 32 || h.reqtypeBytes != expectedReqtypeBytes ||
+        h.offsetBytes != expectedOffsetBytes || !columnsFit) {
+        delete source;
+        return nullptr;
+    }
+
+    source->vpnCursor = source->base + sizeof(CompactTraceHeader);
+    source->offsetCursor = source->vpnCursor + h.vpnBytes;
+    source->vpnEnd = source->offsetCursor;
+    source->reqtypeCursor = source->offsetCursor + h.offsetBytes;
+    source->offsetEnd = source->reqtypeCursor;
+    source->remaining = h.records;
+    return source;
+}
+
+CompactTraceSource::~CompactTraceSource() {
+    if (base) munmap(const_cast<uint8_t*>(base), length);
+}
+
+string CompactTraceSource::error() const {
+    return problem;
+}
+
+unsigned int CompactTraceSource::granularityBits() const {
+    return (header.flags & COMPACT_HAS_OFFSETS) ? 0 : header.offsetBits;
+}
+
+size_t CompactTraceSource::nextBlock(p2AddrTr* records, size_t maxRecords) {
+    size_t n = remaining < maxRecords ? (size_t) remaining : maxRecords;
+    bool hasOffsets = header.flags & COMPACT_HAS_OFFSETS;
+    bool hasReqtype = header.flags & COMPACT_HAS_REQTYPE;
+    unsigned int shift = header.offsetBits;
+
+    for (size_t i = 0; i < n; i++) {
+        uint64_t delta, offset = 0;
+        if (!getVarint(vpnCursor, vpnEnd, &delta) ||
+            (hasOffsets && !getVarint(offsetCursor, offsetEnd, &offset))) {
+            problem = "compact trace is truncated or corrupt";
+            remaining = 0;
+            return i;
+        }
+        lastVpn = (uint32_t) ((int64_t) lastVpn + unzigzag(delta));
+        uint32_t addr = shift >= 32 ? 0 : lastVpn << shift;
+        addr |= (uint32_t) offset;
+
+        p2AddrTr& rec = records[i];
+        rec.addr = addr;
+        rec.reqtype = hasReqtype ? *reqtypeCursor++ : MEMREAD;
+        rec.size = 0;
+        rec.attr = 0;
+        rec.proc = 0;
+        rec.time = 0;
+    }
+    remaining -= n;
+    return n;
+}
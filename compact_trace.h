@@ -0,0 +1,77 @@
+// compact_trace.h
+#ifndef COMPACT_TRACE_H
+#define COMPACT_TRACE_H
+
+#include <cstdint>
+#include <string>
+#include "trace_source.h"
+
+/*
+ * Compact columnar trace produced by pagingwithpr --preprocess.
+ *
+ * A fixed header is followed by up to three columns:
+ *   vpn     - zigzag delta of consecutive VPNs, LEB128 varints
+ *   offset  - page offset of each record, LEB128 varints (optional)
+ *   reqtype - one byte per record (optional)
+ * VPNs are computed for the page size in the header (offsetBits).
+ */
+const char COMPACT_TRACE_MAGIC[8] = {'P', '2', 'T', 'R', 'C', 'M', 'P', '1'};
+
+const uint32_t COMPACT_HAS_OFFSETS = 1;
+const uint32_t COMPACT_HAS_REQTYPE = 2;
+
+struct CompactTraceHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t offsetBits;
+    uint64_t records;
+    uint32_t flags;
+    uint32_t reserved;
+    uint64_t vpnBytes;
+    uint64_t offsetBytes;
+    uint64_t reqtypeBytes;
+};
+
+/* Streams a compact trace straight out of an mmap'd file. */
+class CompactTraceSource : public TraceSource {
+public:
+    ~CompactTraceSource() override;
+    size_t nextBlock(p2AddrTr* records, size_t maxRecords) override;
+    unsigned int granularityBits() const override;
+    bool hasTimestamps() const override { return false; }
+    std::string error() const override;
+
+    // Map path and validate its header; nullptr if it is not a compact trace.
+    static CompactTraceSource* open(const std::string& path);
+
+private:
+    CompactTraceSource() {}
+
+    const uint8_t* base = nullptr;
+    size_t length = 0;
+    CompactTraceHeader header;
+    const uint8_t* vpnCursor = nullptr;
+    const uint8_t* vpnEnd = nullptr;        // end of the VPN column
+    const uint8_t* offsetCursor = nullptr;
+    const uint8_t* offsetEnd = nullptr;     // end of the offset column
+    const uint8_t* reqtypeCursor = nullptr;
+    uint64_t remaining = 0;
+    uint32_t lastVpn = 0;
+    std::string problem;
+};
+
+/**
+ * @brief Convert every record of source into a compact trace.
+ *
+ * @param source - records to convert
+ * @param path - output file
+ * @param offsetBits - page offset bits of the simulated page size
+ * @param flags - COMPACT_HAS_OFFSETS and/or COMPACT_HAS_REQTYPE
+ * @param header - receives the header that was written
+ * @return false if the output could not be written
+ */
+bool writeCompactTrace(TraceSource* source, const std::string& path,
+                       unsigned int offsetBits, uint32_t flags,
+                       CompactTraceHeader* header);
+
+#endif // COMPACT_TRACE_H
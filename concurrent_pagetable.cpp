@@ -0,0 +1,245 @@
+// concurrent_pagetable.cpp
+#include "concurrent_pagetable.h"
+#include <climits>
+#include <thread>
+#include "run_length.h"
+
+using namespace std;
+
+ConcurrentPageTable::ConcurrentPageTable(const vector<int>& levelBits, int numOfFrames, int threads)
+    : shards(max(1, min(threads, numOfFrames))), clocks(max(1, threads)) {
+    levelCount = levelBits.size();
+    numFrames = numOfFrames;
+
+    bitMaskAry = vector<unsigned int>(levelCount, 0);
+    shiftAry = vector<unsigned int>(levelCount, 0);
+    entryCount = vector<unsigned int>(levelCount, 0);
+
+    int currentShift = 32;
+    for (int i = 0; i < levelCount; i++) {
+        currentShift -= levelBits[i];
+        shiftAry[i] = currentShift;
+        bitMaskAry[i] = ((1U << levelBits[i]) - 1) << currentShift;
+        entryCount[i] = (1U << levelBits[i]);
+    }
+    offset = currentShift;
+
+    // Split the frames as evenly as possible, each shard a contiguous range
+    int first = 0;
+    int count = static_cast<int>(shards.size());
+    for (int s = 0; s < count; s++) {
+        shards[s].firstFrame = first;
+        shards[s].numFrames = numFrames / count + (s < numFrames % count ? 1 : 0);
+        first += shards[s].numFrames;
+    }
+
+    rootNode = new ConcurrentLevel(0, this);
+}
+
+ConcurrentPageTable::~ConcurrentPageTable() {
+    delete rootNode;
+}
+
+ConcurrentLevel::ConcurrentLevel(int d, ConcurrentPageTable* root) : depth(d), rootPT(root) {
+    int entries = rootPT->entryCount[d];
+    if (d < rootPT->levelCount - 1) {
+        nextLevel = new atomic<ConcurrentLevel*>[entries];
+        for (int i = 0; i < entries; i++)
+            nextLevel[i].store(nullptr, memory_order_relaxed);
+    } else {
+        mapArray = new ConcurrentMap[entries];
+    }
+    rootPT->entries.fetch_add(entries, memory_order_relaxed);
+}
+
+ConcurrentLevel::~ConcurrentLevel() {
+    int entries = rootPT->entryCount[depth];
+    if (nextLevel) {
+        for (int i = 0; i < entries; i++)
+            delete nextLevel[i].load(memory_order_relaxed);
+        delete[] nextLevel;
+    }
+    delete[] mapArray;
+    rootPT->entries.fetch_sub(entries, memory_order_relaxed);
+}
+
+ConcurrentMap* ConcurrentPageTable::searchMappedPfn(unsigned int virtualAddress) const {
+    ConcurrentLevel* currentLvl = rootNode;
+    for (int i = 0; i < levelCount - 1; i++) {
+        currentLvl = currentLvl->nextLevel[extractVPNIndex(virtualAddress, i)].load(memory_order_acquire);
+        if (!currentLvl) return nullptr;
+    }
+    ConcurrentMap* map = &currentLvl->mapArray[extractVPNIndex(virtualAddress, levelCount - 1)];
+    return map->frameNumber.load(memory_order_acquire) == -1 ? nullptr : map;
+}
+
+// Walk to the leaf entry for virtualAddress, installing missing levels.
+// A thread that loses the race to install a level frees its own copy and
+// continues through the winner's.
+ConcurrentMap* ConcurrentPageTable::findOrInsertLeaf(unsigned int virtualAddress) {
+    ConcurrentLevel* currentLvl = rootNode;
+    for (int i = 0; i < levelCount - 1; i++) {
+        atomic<ConcurrentLevel*>& slot = currentLvl->nextLevel[extractVPNIndex(virtualAddress, i)];
+        ConcurrentLevel* next = slot.load(memory_order_acquire);
+        if (!next) {
+            ConcurrentLevel* fresh = new ConcurrentLevel(i + 1, this);
+            if (slot.compare_exchange_strong(next, fresh, memory_order_acq_rel, memory_order_acquire)) {
+                next = fresh;
+            } else {
+                delete fresh;
+            }
+        }
+        currentLvl = next;
+    }
+    return &currentLvl->mapArray[extractVPNIndex(virtualAddress, levelCount - 1)];
+}
+
+FrameShard& ConcurrentPageTable::shardFor(unsigned int vpn) {
+    uint64_t h = (uint64_t) vpn * 0x9E3779B97F4A7C15ULL;
+    return shards[(size_t) (h >> 32) % shards.size()];
+}
+
+// Catch the shard up with the replay clock. Pages referenced at any point
+// since the last aging get the newest bit; the caller holds shard.lock.
+void ConcurrentPageTable::ageShard(FrameShard& shard) {
+    long now = clock();
+    long epoch = now / nfuInterval;
+    long steps = epoch - shard.agedEpoch;
+    if (steps <= 0) return;
+    shard.agedEpoch = epoch;
+
+    for (int f = 0; f < shard.framesUsed; f++) {
+        uint16_t bits = steps >= 16 ? 0 : static_cast<uint16_t>(shard.bitstring[f] >> steps);
+        if (shard.resident[f]->referenced.exchange(0, memory_order_relaxed)) {
+            bits |= 0x8000;
+            shard.lastSeen[f] = now;
+        }
+        shard.bitstring[f] = bits;
+    }
+}
+
+// NFU victim: the smallest bitstring, ties broken by the reference seen
+// longest ago.
+int ConcurrentPageTable::selectVictim(const FrameShard& shard) const {
+    int victim = 0;
+    unsigned int minBits = UINT_MAX;
+    long oldest = LONG_MAX;
+    for (int f = 0; f < shard.framesUsed; f++) {
+        if (shard.bitstring[f] < minBits || (shard.bitstring[f] == minBits && shard.lastSeen[f] < oldest)) {
+            minBits = shard.bitstring[f];
+            oldest = shard.lastSeen[f];
+            victim = f;
+        }
+    }
+    return victim;
+}
+
+void ConcurrentPageTable::processAddress(unsigned int virtualAddress, ReplayCounters& counters) {
+    counters.accesses++;
+    clocks[counters.thread].accesses.store(counters.accesses, memory_order_relaxed);
+
+    ConcurrentMap* map = searchMappedPfn(virtualAddress);
+    if (map) {
+        counters.pageHits++;
+        if (!map->referenced.load(memory_order_relaxed)) {
+            map->referenced.store(1, memory_order_relaxed);
+        }
+        return;
+    }
+
+    unsigned int vpn = virtualAddress >> offset;
+    FrameShard& shard = shardFor(vpn);
+    lock_guard<mutex> guard(shard.lock);
+
+    // Another thread may have faulted the page in while we waited
+    map = findOrInsertLeaf(virtualAddress);
+    if (map->frameNumber.load(memory_order_relaxed) != -1) {
+        counters.pageHits++;
+        map->referenced.store(1, memory_order_relaxed);
+        return;
+    }
+
+    counters.pageFaults++;
+    ageShard(shard);
+
+    int slot;
+    if (shard.framesUsed < shard.numFrames) {
+        slot = shard.framesUsed++;
+        shard.resident.push_back(map);
+        shard.bitstring.push_back(0);
+        shard.lastSeen.push_back(0);
+    } else {
+        slot = selectVictim(shard);
+        shard.resident[slot]->frameNumber.store(-1, memory_order_release);
+        shard.resident[slot]->referenced.store(0, memory_order_relaxed);
+        shard.resident[slot] = map;
+        counters.pageReplacements++;
+    }
+    shard.bitstring[slot] = 0x8000;
+    shard.lastSeen[slot] = clock();
+    map->referenced.store(0, memory_order_relaxed);
+    map->frameNumber.store(shard.firstFrame + slot, memory_order_release);
+}
+
+// Same-page runs after the first access are hits on a page that access
+// made resident; they are only counted, the referenced bit is already set.
+void ConcurrentPageTable::processAddresses(const uint32_t* addrs, size_t count, ReplayCounters& counters) {
+    size_t i = 0;
+    while (i < count) {
+        unsigned int virtualAddress = addrs[i++];
+        processAddress(virtualAddress, counters);
+        size_t run = sameVpnRun(addrs + i, count - i, virtualAddress >> offset, offset);
+        counters.accesses += run;
+        counters.pageHits += run;
+        i += run;
+    }
+    clocks[counters.thread].accesses.store(counters.accesses, memory_order_relaxed);
+}
+
+long ConcurrentPageTable::framesUsed() const {
+    long used = 0;
+    for (const FrameShard& shard : shards) used += shard.framesUsed;
+    return used;
+}
+
+long ConcurrentPageTable::clock() const {
+    long total = 0;
+    for (const ReplayClock& c : clocks) total += c.accesses.load(memory_order_relaxed);
+    return total;
+}
+
+ReplayCounters runConcurrentReplay(ConcurrentPageTable& pt, const vector<TraceSource*>& sources,
+                                   long maxAddresses) {
+    vector<ReplayCounters> counters(sources.size());
+    vector<thread> threads;
+    for (size_t t = 0; t < sources.size(); t++) {
+        threads.emplace_back([&pt, &sources, &counters, t, maxAddresses]() {
+            vector<p2AddrTr> block(TRACE_BLOCK_RECORDS);
+            vector<uint32_t> addrs(TRACE_BLOCK_RECORDS);
+            ReplayCounters local;
+            local.thread = (int) t;
+            size_t blockSize;
+            while ((maxAddresses == 0 || local.accesses < maxAddresses) &&
+                   (blockSize = sources[t]->nextBlock(block.data(), block.size())) > 0) {
+                if (maxAddresses > 0 && blockSize > (size_t) (maxAddresses - local.accesses)) {
+                    blockSize = maxAddresses - local.accesses;
+                }
+                for (size_t k = 0; k < blockSize; k++) {
+                    addrs[k] = block[k].addr;
+                }
+                pt.processAddresses(addrs.data(), blockSize, local);
+            }
+            counters[t] = local;
+        });
+    }
+
+    ReplayCounters total;
+    for (size_t t = 0; t < threads.size(); t++) {
+        threads[t].join();
+        total.accesses += counters[t].accesses;
+        total.pageHits += counters[t].pageHits;
+        total.pageFaults += counters[t].pageFaults;
+        total.pageReplacements += counters[t].pageReplacements;
+    }
+    return total;
+}
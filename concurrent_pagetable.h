@@ -0,0 +1,139 @@
+// concurrent_pagetable.h
+#ifndef CONCURRENT_PAGETABLE_H
+#define CONCURRENT_PAGETABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "trace_source.h"
+
+class ConcurrentPageTable;
+
+class ConcurrentMap {
+public:
+    std::atomic<int> frameNumber{-1};
+    std::atomic<uint8_t> referenced{0};  // set by hits, consumed by aging
+};
+
+/*
+ * Page table node whose children are published with compare-and-swap, so
+ * walks never take a lock and any thread may extend the tree.
+ */
+class ConcurrentLevel {
+public:
+    int depth;
+    ConcurrentPageTable* rootPT;
+    std::atomic<ConcurrentLevel*>* nextLevel = nullptr;
+    ConcurrentMap* mapArray = nullptr;
+
+    ConcurrentLevel(int d, ConcurrentPageTable* root);
+    ~ConcurrentLevel();
+};
+
+/*
+ * Replacement state for a slice of physical memory. Pages are assigned to
+ * shards by VPN, so a fault only locks the shard owning the page and
+ * faults in other shards proceed in parallel. Each shard runs NFU over
+ * its own frames.
+ */
+struct alignas(64) FrameShard {
+    std::mutex lock;
+    int firstFrame = 0;
+    int numFrames = 0;
+    int framesUsed = 0;
+    long agedEpoch = 0;
+    std::vector<ConcurrentMap*> resident;  // by frame - firstFrame
+    std::vector<uint16_t> bitstring;
+    std::vector<long> lastSeen;  // clock when the page was last seen referenced
+};
+
+/* Replay progress of one thread, on its own cache line. */
+struct alignas(64) ReplayClock {
+    std::atomic<long> accesses{0};
+};
+
+/* Per-thread counters, summed once replay finishes. */
+struct ReplayCounters {
+    int thread = 0;
+    long accesses = 0;
+    long pageHits = 0;
+    long pageFaults = 0;
+    long pageReplacements = 0;
+};
+
+/*
+ * Page table shared by several replay threads. Lookups are wait-free: a
+ * bounded walk of atomic loads. Missing levels are installed with CAS and
+ * the loser of a race frees its copy. Leaf frames are atomics written
+ * only under the owning shard's lock, so a fault and an eviction of the
+ * same page cannot interleave. A lookup racing with an eviction may still
+ * count as a hit, much like a stale TLB entry.
+ *
+ * NFU aging runs against the total progress of all threads: each shard, when
+ * it next takes a fault, shifts its bitstrings once for every nfuInterval
+ * accesses replayed since it last aged, folding in the referenced bits
+ * that hits left behind. The result is NFU at interval granularity rather
+ * than the exact per-access order of PageTable, which a concurrent replay
+ * does not have. Ties go to the page whose reference was seen longest ago.
+ */
+class ConcurrentPageTable {
+public:
+    int levelCount;
+    std::vector<unsigned int> bitMaskAry;
+    std::vector<unsigned int> shiftAry;
+    std::vector<unsigned int> entryCount;
+    std::atomic<unsigned long> entries{0};
+    int nfuInterval = 10;
+    int offset;
+
+    ConcurrentLevel* rootNode = nullptr;
+
+    int numFrames;
+    std::vector<FrameShard> shards;
+
+    std::vector<ReplayClock> clocks;  // one per replay thread
+
+    // One shard and one clock per replay thread.
+    ConcurrentPageTable(const std::vector<int>& levelBits, int numOfFrames, int threads);
+    ~ConcurrentPageTable();
+    ConcurrentPageTable(const ConcurrentPageTable&) = delete;
+    ConcurrentPageTable& operator=(const ConcurrentPageTable&) = delete;
+
+    unsigned int extractVPNIndex(unsigned int virtualAddress, int level) const {
+        return (virtualAddress & bitMaskAry[level]) >> shiftAry[level];
+    }
+
+    // Leaf entry for virtualAddress if it holds a frame, without locking.
+    ConcurrentMap* searchMappedPfn(unsigned int virtualAddress) const;
+
+    // Simulate one access from a replay thread.
+    void processAddress(unsigned int virtualAddress, ReplayCounters& counters);
+
+    // Simulate a block of addresses from one replay thread.
+    void processAddresses(const uint32_t* addrs, size_t count, ReplayCounters& counters);
+
+    long framesUsed() const;
+
+    // Accesses replayed so far by all threads.
+    long clock() const;
+
+private:
+    ConcurrentMap* findOrInsertLeaf(unsigned int virtualAddress);
+    FrameShard& shardFor(unsigned int vpn);
+    void ageShard(FrameShard& shard);
+    int selectVictim(const FrameShard& shard) const;
+};
+
+/**
+ * @brief Replay each trace on its own thread against one shared table.
+ *
+ * @param pt - shared page table
+ * @param sources - one trace per thread, consumed
+ * @param maxAddresses - records to replay from each trace, 0 for all
+ * @return counters summed over all threads
+ */
+ReplayCounters runConcurrentReplay(ConcurrentPageTable& pt, const std::vector<TraceSource*>& sources,
+                                   long maxAddresses);
+
+#endif // CONCURRENT_PAGETABLE_H
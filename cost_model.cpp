@@ -0,0 +1,69 @@
+// cost_model.cpp
+#include "cost_model.h"
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+using namespace std;
+
+string parseLatencyConfig(const string& text, LatencyConfig* latency) {
+    stringstream ss(text);
+    string item;
+    while (getline(ss, item, ',')) {
+        size_t eq = item.find('=');
+        string key = item.substr(0, eq);
+        string value = eq == string::npos ? "" : item.substr(eq + 1);
+        char* rest;
+        double ns = strtod(value.c_str(), &rest);
+        if (value.empty() || *rest != '\0' || ns < 0)
+            return "Latency " + item + " must be key=nanoseconds";
+
+        if (key == "tlb") latency->tlbHit = ns;
+        else if (key == "walk") latency->walkLevel = ns;
+        else if (key == "fault") latency->fault = ns;
+        else if (key == "writeback") latency->writeback = ns;
+        else return "Unknown latency " + key + ", expected tlb, walk, fault or writeback";
+    }
+    return "";
+}
+
+CostModel::CostModel(const LatencyConfig& latency) : latency(latency) {
+    tlb.reserve(latency.tlbEntries);
+}
+
+void CostModel::access(uint32_t vpn, int levels, bool fault) {
+    totalNs += latency.tlbHit;
+
+    auto it = find(tlb.begin(), tlb.end(), vpn);
+    if (it != tlb.end()) {
+        tlbHits++;
+        rotate(tlb.begin(), it, it + 1);
+        return;
+    }
+
+    tlbMisses++;
+    totalNs += latency.walkLevel * levels;
+    if (fault) totalNs += latency.fault;
+
+    if ((int) tlb.size() < latency.tlbEntries) {
+        tlb.insert(tlb.begin(), vpn);
+    } else if (!tlb.empty()) {
+        tlb.pop_back();
+        tlb.insert(tlb.begin(), vpn);
+    }
+}
+
+void CostModel::repeatHits(long count) {
+    tlbHits += count;
+    totalNs += latency.tlbHit * count;
+}
+
+void CostModel::writeback(unsigned int pages) {
+    totalNs += latency.writeback * pages;
+}
+
+void CostModel::invalidate(uint32_t vpn, uint32_t pages) {
+    tlb.erase(remove_if(tlb.begin(), tlb.end(),
+                        [vpn, pages](uint32_t entry) { return entry - vpn < pages; }),
+              tlb.end());
+}
@@ -0,0 +1,58 @@
+// cost_model.h
+#ifndef COST_MODEL_H
+#define COST_MODEL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* Latencies in nanoseconds charged by the cost model (--latency). */
+struct LatencyConfig {
+    double tlbHit = 1;          // every access pays the TLB lookup
+    double walkLevel = 20;      // each page table level read on a TLB miss
+    double fault = 100000;      // servicing a page fault from backing store
+    double writeback = 100000;  // writing a dirty victim back first
+    int tlbEntries = 64;
+};
+
+/**
+ * @brief Parse "tlb=1,walk=20,fault=100000,writeback=100000"; keys left
+ *        out keep their current value in latency.
+ * @return empty on success, otherwise the reason the text was rejected
+ */
+std::string parseLatencyConfig(const std::string& text, LatencyConfig* latency);
+
+/*
+ * Turns the simulator's events into time: a small fully associative LRU
+ * TLB in front of the page table, a walk cost per level read on a TLB
+ * miss, and fault and write-back service times. Entries for evicted pages
+ * are shot down, so a fault always misses the TLB.
+ */
+class CostModel {
+public:
+    explicit CostModel(const LatencyConfig& latency);
+
+    // Charge one access to vpn; levels is how many page table levels a
+    // walk for it reads.
+    void access(uint32_t vpn, int levels, bool fault);
+
+    // Charge count more accesses to the page just accessed, which is
+    // already the most recent TLB entry.
+    void repeatHits(long count);
+
+    // Charge writing pages dirty pages back on eviction.
+    void writeback(unsigned int pages);
+
+    // Drop TLB entries for pages [vpn, vpn + pages).
+    void invalidate(uint32_t vpn, uint32_t pages);
+
+    LatencyConfig latency;
+    long tlbHits = 0;
+    long tlbMisses = 0;
+    double totalNs = 0;
+
+private:
+    std::vector<uint32_t> tlb;  // resident VPNs, most recent first
+};
+
+#endif // COST_MODEL_H
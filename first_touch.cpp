@@ -0,0 +1,194 @@
+// first_touch.cpp
+#include "first_touch.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include "flat_vpn_map.h"
+#include "run_length.h"
+
+using namespace std;
+
+// Records read and scanned per parallel round.
+static const size_t SUPERBLOCK_RECORDS = 1 << 20;
+
+// NFU bitstrings remember this many aging intervals.
+static const int NFU_HISTORY = 16;
+
+struct ChunkEntry {
+    uint64_t first = 0;
+    uint64_t last = 0;
+};
+
+struct ChunkResult {
+    FlatVpnMap<ChunkEntry> pages;
+    vector<uint32_t> order;  // VPNs by first touch within the chunk
+};
+
+struct PageEntry {
+    uint64_t first = 0;
+    uint64_t last = 0;
+    Map* map = nullptr;
+};
+
+bool firstTouchEligible(const PageTable& pt) {
+    return pt.nfuInterval > 0 &&
+           (uint64_t) pt.nfuInterval * (NFU_HISTORY + 1) <= SUPERBLOCK_RECORDS;
+}
+
+static void scanChunk(const uint32_t* addrs, size_t n, uint64_t base, unsigned int shift,
+                      ChunkResult* out) {
+    out->pages.clear();
+    out->order.clear();
+    size_t i = 0;
+    while (i < n) {
+        uint32_t vpn = addrs[i] >> shift;
+        size_t run = 1 + sameVpnRun(addrs + i + 1, n - i - 1, vpn, shift);
+        bool inserted;
+        ChunkEntry& entry = out->pages.findOrInsert(vpn, inserted);
+        if (inserted) {
+            entry.first = base + i;
+            out->order.push_back(vpn);
+        }
+        entry.last = base + i + run - 1;
+        i += run;
+    }
+}
+
+/*
+ * The records most recently read: the block before the current one and
+ * the current one, enough to replay the last NFU_HISTORY intervals.
+ */
+struct RecentRecords {
+    vector<uint32_t> prev, cur;
+    uint64_t prevBase = 0, curBase = 0;
+
+    uint32_t at(uint64_t index) const {
+        return index >= curBase ? cur[index - curBase] : prev[index - prevBase];
+    }
+};
+
+// Put pt in the state the serial engine reaches after `accesses` records,
+// given every page first touched before that point.
+static void rebuildSerialState(PageTable& pt, FlatVpnMap<PageEntry>& pages,
+                               const vector<uint32_t>& touchOrder,
+                               const RecentRecords& recent, uint64_t accesses) {
+    unsigned int shift = pt.offset;
+    uint64_t interval = pt.nfuInterval;
+    uint64_t agings = accesses / interval;
+
+    for (size_t frame = 0; frame < touchOrder.size(); frame++) {
+        uint32_t vpn = touchOrder[frame];
+        unsigned int virtualAddress = vpn << shift;
+        pt.insertMapForVpn2Pfn(&pt, virtualAddress, static_cast<int>(frame));
+        PageEntry* entry = pages.find(vpn);
+        Map* map = pt.searchMappedPfn(&pt, virtualAddress);
+        map->vpn = vpn;
+        map->lastAccessTime = static_cast<long>(entry->last);
+
+        // A page starts with the top bit set and is shifted by every aging
+        // that happens after the access that loaded it.
+        uint64_t agedSinceLoad = agings - (entry->first + 1) / interval;
+        map->bitstring = agedSinceLoad < NFU_HISTORY ? (1U << 15) >> agedSinceLoad : 0;
+
+        entry->map = map;
+        pt.addLoadedPage(map);
+    }
+
+    // Replay the intervals that still show in the bitstrings, then collect
+    // the pages referenced so far in the current, unfinished interval.
+    uint64_t window = agings > NFU_HISTORY ? (agings - NFU_HISTORY) * interval : 0;
+    for (uint64_t i = window; i < accesses; i++) {
+        PageEntry* entry = pages.find(recent.at(i) >> shift);
+        uint64_t k = i / interval;
+        if (k < agings) {
+            // A page loaded by the access that triggers an aging is not
+            // marked for that interval.
+            if (i == entry->first && i == (k + 1) * interval - 1) continue;
+            entry->map->bitstring |= (1U << 15) >> (agings - 1 - k);
+        } else {
+            pt.accessedPagesInInterval.insert(entry->map);
+        }
+    }
+
+    pt.nfuCounter = static_cast<int>(accesses % interval);
+    pt.framesUsed = static_cast<int>(touchOrder.size());
+    pt.pageFaults = static_cast<long>(touchOrder.size());
+    pt.accesses = static_cast<long>(accesses);
+    pt.pageHits = pt.accesses - pt.pageFaults;
+}
+
+void runFirstTouchParallel(PageTable& pt, TraceSource* source, long maxAddresses) {
+    unsigned int threads = max(1U, thread::hardware_concurrency());
+    unsigned int shift = pt.offset;
+    vector<ChunkResult> chunks(threads);
+    vector<p2AddrTr> block(TRACE_BLOCK_RECORDS);
+    vector<uint32_t> next;
+    RecentRecords recent;
+    FlatVpnMap<PageEntry> pages;
+    vector<uint32_t> touchOrder;
+    uint64_t total = 0;
+    uint64_t limit = maxAddresses > 0 ? (uint64_t) maxAddresses : UINT64_MAX;
+
+    while (total < limit) {
+        next.clear();
+        while (next.size() < SUPERBLOCK_RECORDS && total + next.size() < limit) {
+            size_t want = min<uint64_t>(block.size(), SUPERBLOCK_RECORDS - next.size());
+            want = min<uint64_t>(want, limit - total - next.size());
+            size_t n = source->nextBlock(block.data(), want);
+            if (n == 0) break;
+            for (size_t k = 0; k < n; k++) next.push_back(block[k].addr);
+        }
+        if (next.empty()) break;
+
+        recent.prev.swap(recent.cur);
+        recent.prevBase = recent.curBase;
+        recent.cur.swap(next);
+        recent.curBase = total;
+
+        const vector<uint32_t>& cur = recent.cur;
+        size_t chunkLen = (cur.size() + threads - 1) / threads;
+        vector<thread> workers;
+        for (unsigned int t = 0; t < threads; t++) {
+            size_t start = min(cur.size(), t * chunkLen);
+            size_t len = min(chunkLen, cur.size() - start);
+            workers.emplace_back(scanChunk, cur.data() + start, len, total + start, shift, &chunks[t]);
+        }
+        for (thread& worker : workers) worker.join();
+
+        for (unsigned int t = 0; t < threads; t++) {
+            ChunkResult& chunk = chunks[t];
+            size_t fresh = 0;
+            for (uint32_t vpn : chunk.order) {
+                if (!pages.find(vpn)) fresh++;
+            }
+
+            if (touchOrder.size() + fresh > (size_t) pt.numFrames) {
+                // Replacement would be needed inside this chunk: hand the
+                // rest of the block to the serial engine.
+                size_t start = min(cur.size(), t * chunkLen);
+                rebuildSerialState(pt, pages, touchOrder, recent, total + start);
+                pt.processAddresses(cur.data() + start, cur.size() - start, "");
+                return;
+            }
+
+            if (pt.profiler) {
+                size_t start = min(cur.size(), t * chunkLen);
+                pt.profiler->recordFirstTouches(cur.data() + start, min(chunkLen, cur.size() - start), shift);
+            }
+
+            for (uint32_t vpn : chunk.order) {
+                bool inserted;
+                PageEntry& entry = pages.findOrInsert(vpn, inserted);
+                ChunkEntry* local = chunk.pages.find(vpn);
+                if (inserted) {
+                    entry.first = local->first;
+                    touchOrder.push_back(vpn);
+                }
+                entry.last = local->last;
+            }
+        }
+        total += cur.size();
+    }
+
+    rebuildSerialState(pt, pages, touchOrder, recent, total);
+}
@@ -0,0 +1,34 @@
+// first_touch.h
+#ifndef FIRST_TOUCH_H
+#define FIRST_TOUCH_H
+
+#include "pagetable.h"
+#include "trace_source.h"
+
+/**
+ * @brief Whether the first-touch fast path can reproduce pt exactly.
+ *
+ * Rebuilding NFU state at a fallback point replays the last 16 aging
+ * intervals, which must fit in the records kept in memory.
+ */
+bool firstTouchEligible(const PageTable& pt);
+
+/**
+ * @brief Simulate while no page replacement is needed, in parallel.
+ *
+ * While every page fits in a free frame, hits and misses depend only on
+ * the first touch of each VPN and frames are handed out in first-touch
+ * order. The trace is read in large blocks, each split into per-thread
+ * chunks whose first-touch sets are built concurrently and merged in
+ * order. When a chunk would need more frames than are available, pt is
+ * rebuilt in the exact state the serial engine would have at the start of
+ * that chunk, and the rest of the block goes through
+ * PageTable::processAddresses. The caller then continues serially.
+ *
+ * @param pt - page table, fresh
+ * @param source - trace records, consumed up to maxAddresses
+ * @param maxAddresses - stop after this many records, 0 for all
+ */
+void runFirstTouchParallel(PageTable& pt, TraceSource* source, long maxAddresses);
+
+#endif // FIRST_TOUCH_H
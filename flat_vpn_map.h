@@ -0,0 +1,88 @@
+// flat_vpn_map.h
+#ifndef FLAT_VPN_MAP_H
+#define FLAT_VPN_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Open-addressing hash map keyed by virtual page number, with linear
+ * probing and values stored inline. Slots hold vpn + 1 so that 0 marks an
+ * empty slot; VPNs are at most 31 bits wide.
+ */
+template <class V>
+class FlatVpnMap {
+public:
+    explicit FlatVpnMap(size_t expected = 16) {
+        size_t capacity = 16;
+        while (capacity < expected * 2) capacity <<= 1;
+        keys.assign(capacity, 0);
+        values.resize(capacity);
+    }
+
+    // Value for vpn, inserting a default value first if it is absent.
+    V& findOrInsert(uint32_t vpn, bool& inserted) {
+        if ((count + 1) * 2 > keys.size()) grow();
+        size_t slot = probe(vpn);
+        inserted = keys[slot] == 0;
+        if (inserted) {
+            keys[slot] = vpn + 1;
+            values[slot] = V();
+            count++;
+        }
+        return values[slot];
+    }
+
+    V* find(uint32_t vpn) {
+        size_t slot = probe(vpn);
+        return keys[slot] ? &values[slot] : nullptr;
+    }
+
+    size_t size() const { return count; }
+
+    void clear() {
+        keys.assign(keys.size(), 0);
+        count = 0;
+    }
+
+    template <class F>
+    void forEach(F visit) const {
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (keys[i]) visit(keys[i] - 1, values[i]);
+        }
+    }
+
+private:
+    static size_t hash(uint32_t vpn) {
+        uint64_t h = (uint64_t) vpn * 0x9E3779B97F4A7C15ULL;
+        return (size_t) (h >> 32);
+    }
+
+    size_t probe(uint32_t vpn) const {
+        size_t mask = keys.size() - 1;
+        size_t slot = hash(vpn) & mask;
+        while (keys[slot] != 0 && keys[slot] != vpn + 1) slot = (slot + 1) & mask;
+        return slot;
+    }
+
+    void grow() {
+        std::vector<uint32_t> oldKeys(keys.size() * 2, 0);
+        std::vector<V> oldValues(values.size() * 2);
+        oldKeys.swap(keys);
+        oldValues.swap(values);
+        for (size_t i = 0; i < oldKeys.size(); i++) {
+            if (oldKeys[i]) {
+                size_t slot = probe(oldKeys[i] - 1);
+                keys[slot] = oldKeys[i];
+                values[slot] = oldValues[i];
+            }
+        }
+    }
+
+    std::vector<uint32_t> keys;
+    std::vector<V> values;
+    size_t count = 0;
+};
+
+#endif // FLAT_VPN_MAP_H
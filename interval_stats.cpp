@@ -0,0 +1,56 @@
+// interval_stats.cpp
+#include "interval_stats.h"
+#include "pagetable.h"
+
+using namespace std;
+
+IntervalReporter::IntervalReporter(long every, FILE* out, bool json, bool workingSet)
+    : every(every), out(out), json(json), workingSet(workingSet), lastTime(chrono::steady_clock::now()) {
+    if (!json) {
+        fprintf(out, "accesses,window,hits,faults,hit_rate,replacements,"
+                     "frames_in_use,page_table_bytes,records_per_sec%s\n",
+                workingSet ? ",working_set" : "");
+    }
+}
+
+void IntervalReporter::report(const PageTable& pt) {
+    long window = pt.accesses - lastAccesses;
+    if (window <= 0) return;
+
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    double seconds = chrono::duration<double>(now - lastTime).count();
+    long hits = pt.pageHits - lastHits;
+    long faults = pt.pageFaults - lastFaults;
+    long replacements = pt.pageReplacements - lastReplacements;
+    double hitRate = (double) hits / (double) window;
+    double rate = seconds > 0 ? window / seconds : 0.0;
+    long framesInUse = pt.framesInUse();
+
+    if (json) {
+        fprintf(out, "{\"accesses\":%ld,\"window\":%ld,\"hits\":%ld,\"faults\":%ld,"
+                     "\"hit_rate\":%.6f,\"replacements\":%ld,\"frames_in_use\":%ld,"
+                     "\"page_table_bytes\":%lu,\"records_per_sec\":%.0f",
+                pt.accesses, window, hits, faults, hitRate, replacements, framesInUse,
+                pt.tableBytes, rate);
+        if (workingSet) fprintf(out, ",\"working_set\":%ld", pt.workingSetSize());
+        fprintf(out, "}\n");
+    } else {
+        fprintf(out, "%ld,%ld,%ld,%ld,%.6f,%ld,%ld,%lu,%.0f",
+                pt.accesses, window, hits, faults, hitRate, replacements, framesInUse,
+                pt.tableBytes, rate);
+        if (workingSet) fprintf(out, ",%ld", pt.workingSetSize());
+        fprintf(out, "\n");
+    }
+    fflush(out);
+
+    rebase(pt);
+    lastTime = now;
+}
+
+void IntervalReporter::rebase(const PageTable& pt) {
+    lastAccesses = pt.accesses;
+    lastHits = pt.pageHits;
+    lastFaults = pt.pageFaults;
+    lastReplacements = pt.pageReplacements;
+    lastTime = chrono::steady_clock::now();
+}
@@ -0,0 +1,41 @@
+// interval_stats.h
+#ifndef INTERVAL_STATS_H
+#define INTERVAL_STATS_H
+
+#include <chrono>
+#include <cstdio>
+
+class PageTable;
+
+/*
+ * Windowed statistics emitted every N accesses (--interval N), one CSV
+ * row or JSON object per line. Each record covers the accesses since the
+ * previous one, so working-set phase changes and throughput drops show up
+ * while a long run is still going. In working-set mode each record also
+ * carries the working-set size at its end.
+ */
+class IntervalReporter {
+public:
+    IntervalReporter(long every, FILE* out, bool json, bool workingSet = false);
+
+    long every;
+
+    // Emit a record for the accesses since the previous report.
+    void report(const PageTable& pt);
+
+    // Start the next window at pt's current counters, e.g. after resuming
+    // from a checkpoint.
+    void rebase(const PageTable& pt);
+
+private:
+    FILE* out;
+    bool json;
+    bool workingSet;
+    long lastAccesses = 0;
+    long lastHits = 0;
+    long lastFaults = 0;
+    long lastReplacements = 0;
+    std::chrono::steady_clock::time_point lastTime;
+};
+
+#endif // INTERVAL_STATS_H
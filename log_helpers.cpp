@@ -141,4 +141,132 @@ void log_summary(unsigned int page_size,
   printf("Number of page table entries: %ld\n", pgtableEntries);
 
   fflush(stdout);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief log superpage statistics, printed after the summary when
+ *        superpage promotion is enabled.
+ *
+ * @param large_page_size - Number of bytes per superpage
+ * @param promotions - Number of leaf tables coalesced into superpages
+ * @param migrations - Promotions that first moved pages to aligned frames
+ * @param demotions - Number of superpages evicted
+ * @param largePageHits - Number of accesses served by a superpage
+ * @param numOfAddresses - Number of addresses processed
+ */
+void log_superpages(unsigned long int large_page_size,
+                    unsigned long int promotions,
+                    unsigned long int migrations,
+                    unsigned long int demotions,
+                    unsigned long int largePageHits,
+                    unsigned long int numOfAddresses) {
+  double large_percent = numOfAddresses ?
+    (double) largePageHits / (double) numOfAddresses * 100.0 : 0.0;
+
+  printf("Large page size: %lu bytes\n", large_page_size);
+  printf("Superpage promotions: %lu (%lu migrated), demotions: %lu\n",
+         promotions, migrations, demotions);
+  printf("Accesses served by large pages: %lu (%.2f%%)\n",
+         largePageHits, large_percent);
+
+  fflush(stdout);
+}
+
+void log_prefetch(unsigned long int issued,
+                  unsigned long int used,
+                  unsigned long int evicted,
+                  unsigned long int misses) {
+  double accuracy = issued ? (double) used / (double) issued * 100.0 : 0.0;
+  double coverage = used + misses ?
+    (double) used / (double) (used + misses) * 100.0 : 0.0;
+
+  printf("Prefetched pages: %lu, used: %lu, evicted unused: %lu\n",
+         issued, used, evicted);
+  printf("Prefetch accuracy: %.2f%%, coverage: %.2f%%\n", accuracy, coverage);
+
+  fflush(stdout);
+}
+
+void log_working_set(unsigned long int window,
+                     unsigned long int reclaimed,
+                     unsigned long int residentFrameSum,
+                     unsigned long int peakFrames,
+                     unsigned long int numOfAddresses) {
+  double average = numOfAddresses ?
+    (double) residentFrameSum / (double) numOfAddresses : 0.0;
+
+  printf("Working set window: %lu accesses, pages reclaimed: %lu\n", window, reclaimed);
+  printf("Average resident frames: %.2f, peak: %lu\n", average, peakFrames);
+
+  fflush(stdout);
+}
+
+void log_cost_model(double totalNs,
+                    double tlbHitNs,
+                    unsigned long int tlbHits,
+                    unsigned long int tlbMisses,
+                    unsigned long int writebacks,
+                    unsigned long int numOfAddresses) {
+  double eat = numOfAddresses ? totalNs / (double) numOfAddresses : 0.0;
+  double stallNs = totalNs - tlbHitNs * (double) numOfAddresses;
+  double tlb_percent = numOfAddresses ?
+    (double) tlbHits / (double) numOfAddresses * 100.0 : 0.0;
+
+  printf("TLB hits: %lu (%.2f%%), misses: %lu\n", tlbHits, tlb_percent, tlbMisses);
+  printf("Dirty page write-backs: %lu\n", writebacks);
+  printf("Effective access time: %.2f ns\n", eat);
+  printf("Estimated stall time: %.6f s (%.2f%% of %.6f s)\n", stallNs / 1e9,
+         totalNs ? stallNs / totalNs * 100.0 : 0.0, totalNs / 1e9);
+
+  fflush(stdout);
+}
+
+void log_reuse_histogram(const long* buckets, int count) {
+  long total = 0;
+  int last = 0;
+  for (int i = 0; i < count; i++) {
+    total += buckets[i];
+    if (buckets[i]) last = i;
+  }
+
+  printf("Reuse distance (distinct pages):\n");
+  for (int i = 0; i <= last; i++) {
+    char range[48];  // two 20-digit bounds and a dash
+    if (i == 0)
+      snprintf(range, sizeof(range), "cold");
+    else if (i == 1)
+      snprintf(range, sizeof(range), "0");
+    else if (i == 2)
+      snprintf(range, sizeof(range), "1");
+    else
+      snprintf(range, sizeof(range), "%lu-%lu", 1UL << (i - 2), (1UL << (i - 1)) - 1);
+    printf("  %-24s %12ld %6.2f%%\n", range, buckets[i],
+           total ? (double) buckets[i] / (double) total * 100.0 : 0.0);
+  }
+
+  fflush(stdout);
+}
+
+void log_policy_header(unsigned int page_size, unsigned long int numOfAddresses) {
+  printf("Page size: %d bytes\n", page_size);
+  printf("Addresses processed: %lu\n", numOfAddresses);
+  printf("%-12s %12s %12s %14s %8s %8s\n",
+         "Policy", "Hits", "Misses", "Replacements", "Hit %", "Frames");
+
+  fflush(stdout);
+}
+
+void log_policy_row(const char* policy,
+                    unsigned long int pageTableHits,
+                    unsigned long int misses,
+                    unsigned long int numOfPageReplaces,
+                    unsigned long int numOfFramesAllocated,
+                    unsigned long int numOfAddresses) {
+  double hit_percent = numOfAddresses ?
+    (double) pageTableHits / (double) numOfAddresses * 100.0 : 0.0;
+
+  printf("%-12s %12lu %12lu %14lu %7.2f%% %8lu\n", policy, pageTableHits,
+         misses, numOfPageReplaces, hit_percent, numOfFramesAllocated);
+
+  fflush(stdout);
+}
@@ -81,4 +81,110 @@ void log_summary(unsigned int page_size,
                  unsigned int numOfFramesAllocated,
                  unsigned long int pgtableEntries);
 
+/**
+ * @brief log superpage statistics, printed after the summary when
+ *        superpage promotion is enabled.
+ *
+ * @param large_page_size - Number of bytes per superpage
+ * @param promotions - Number of leaf tables coalesced into superpages
+ * @param migrations - Promotions that first moved pages to aligned frames
+ * @param demotions - Number of superpages evicted
+ * @param largePageHits - Number of accesses served by a superpage
+ * @param numOfAddresses - Number of addresses processed
+ */
+void log_superpages(unsigned long int large_page_size,
+                    unsigned long int promotions,
+                    unsigned long int migrations,
+                    unsigned long int demotions,
+                    unsigned long int largePageHits,
+                    unsigned long int numOfAddresses);
+
+/**
+ * @brief log read-ahead statistics, printed after the summary when a
+ *        prefetch policy is enabled. Accuracy is the share of prefetched
+ *        pages that were used; coverage is the share of would-be faults
+ *        that prefetching turned into hits.
+ *
+ * @param issued - Number of pages loaded ahead of demand
+ * @param used - Prefetched pages accessed before eviction
+ * @param evicted - Prefetched pages evicted before any access
+ * @param misses - Number of demand page faults
+ */
+void log_prefetch(unsigned long int issued,
+                  unsigned long int used,
+                  unsigned long int evicted,
+                  unsigned long int misses);
+
+/**
+ * @brief log working-set mode statistics, printed after the summary. Every
+ *        window accesses, pages not referenced during the window are
+ *        reclaimed and their frames reused before new ones are allocated.
+ *
+ * @param window - Working-set window in accesses
+ * @param reclaimed - Pages freed for falling out of the working set
+ * @param residentFrameSum - Frames in use summed over every access
+ * @param peakFrames - Most frames in use at once
+ * @param numOfAddresses - Number of memory accesses
+ */
+void log_working_set(unsigned long int window,
+                     unsigned long int reclaimed,
+                     unsigned long int residentFrameSum,
+                     unsigned long int peakFrames,
+                     unsigned long int numOfAddresses);
+
+/**
+ * @brief log the --latency cost model: effective access time is the modeled
+ *        time per access, stall time the part of it spent beyond a TLB hit.
+ *
+ * @param totalNs - Modeled time for every access, in nanoseconds
+ * @param tlbHitNs - Latency of a TLB hit
+ * @param tlbHits - Accesses translated by the TLB
+ * @param tlbMisses - Accesses that walked the page table
+ * @param writebacks - Dirty pages written back on eviction
+ * @param numOfAddresses - Number of memory accesses
+ */
+void log_cost_model(double totalNs,
+                    double tlbHitNs,
+                    unsigned long int tlbHits,
+                    unsigned long int tlbMisses,
+                    unsigned long int writebacks,
+                    unsigned long int numOfAddresses);
+
+/**
+ * @brief log the reuse distance histogram collected by --profile. Bucket 0
+ *        counts first touches, bucket 1 distance 0, and bucket k > 1
+ *        distances in [2^(k-2), 2^(k-1)); trailing empty buckets are
+ *        omitted.
+ *
+ * @param buckets - Accesses per bucket
+ * @param count - Number of buckets
+ */
+void log_reuse_histogram(const long* buckets, int count);
+
+/**
+ * @brief log the header of the per-policy table printed by --policies.
+ *
+ * @param page_size - Number of bytes per page
+ * @param numOfAddresses - Number of addresses processed
+ */
+void log_policy_header(unsigned int page_size, unsigned long int numOfAddresses);
+
+/**
+ * @brief log one replacement policy's results as a row of the --policies
+ *        table.
+ *
+ * @param policy - Policy name, e.g. nfu:10
+ * @param pageTableHits - Number of page hits
+ * @param misses - Number of page faults
+ * @param numOfPageReplaces - Number of page replacements
+ * @param numOfFramesAllocated - Number of frames in use at the end
+ * @param numOfAddresses - Number of addresses processed
+ */
+void log_policy_row(const char* policy,
+                    unsigned long int pageTableHits,
+                    unsigned long int misses,
+                    unsigned long int numOfPageReplaces,
+                    unsigned long int numOfFramesAllocated,
+                    unsigned long int numOfAddresses);
+
 #endif // LOG_HELPERS_H
\ No newline at end of file
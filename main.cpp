@@ -6,9 +6,13 @@
 #include <cstdio>
 #include <getopt.h>
 #include <cctype>
-#include "vaddr_tracereader.h"
 #include "log_helpers.h"
 #include "pagetable.h"
+#include "pagingsim.h"
+#include "trace_source.h"
+#include "compact_trace.h"
+#include "multi_policy.h"
+#include "concurrent_pagetable.h"
 
 using namespace std;
 
@@ -21,12 +25,17 @@ bool isValidInteger(const string& str) {
 
 int main(int argc, char* argv[]) {
     // Default values for optional arguments
-    int numFrames = 999999; // Default infinite frames
+    PagingSimConfig config; // frames, -b interval and levels default in the library
     int maxAddresses = 0; // 0 means process all
-    int nfuInterval = 10; // Default 10 if -b not provided
-    string logOption;
+    string preprocessFile; // --preprocess writes a compact trace instead of simulating
+    uint32_t compactFlags = COMPACT_HAS_OFFSETS;
+    string intervalFormat = "csv";
+    string intervalFile; // defaults to stderr
     string traceFile;
-    vector<int> levelBits;
+    vector<string> traceFiles; // --concurrent replays every trace on its own thread
+    string resumeFile; // --resume continues from a checkpoint
+    string profileFile; // --profile writes per-VPN statistics
+    string policyList; // --policies runs several replacement policies in one pass
 
     for (int i = 1; i < argc; ++i) {
         string arg = argv[i];
@@ -38,79 +47,275 @@ int main(int argc, char* argv[]) {
                 return 0;
             }
         } else if (arg == "-f" && i + 1 < argc) {
-            numFrames = atoi(argv[++i]);
-            if (numFrames < 1) {
+            config.numFrames = atoi(argv[++i]);
+            if (config.numFrames < 1) {
                 cout << "Number of available frames must be a number and greater than 0" << endl;
                 return 0;
             }
         } else if (arg == "-b" && i + 1 < argc) {
-            nfuInterval = atoi(argv[++i]);
-            if (nfuInterval < 1) {
+            config.nfuInterval = atoi(argv[++i]);
+            if (config.nfuInterval < 1) {
                 cout << "Bit string update interval must be a number and greater than 0" << endl;
                 return 0;
             }
+        } else if (arg == "--age-ticks" && i + 1 < argc) {
+            config.ageTicks = atol(argv[++i]);
+            if (config.ageTicks < 1) {
+                cout << "Aging tick interval must be a number and greater than 0" << endl;
+                return 0;
+            }
+        } else if (arg == "--latency" && i + 1 < argc) {
+            string problem = parseLatencyConfig(argv[++i], &config.latency);
+            if (!problem.empty()) {
+                cout << problem << endl;
+                return 0;
+            }
+            config.modelCosts = true;
+        } else if (arg == "--tlb" && i + 1 < argc) {
+            config.latency.tlbEntries = atoi(argv[++i]);
+            if (config.latency.tlbEntries < 1) {
+                cout << "Number of TLB entries must be a number and greater than 0" << endl;
+                return 0;
+            }
+            config.modelCosts = true;
         } else if (arg == "-l" && i + 1 < argc) {
-            logOption = argv[++i];
-        } else if (arg.find(".tr") != string::npos) {
+            config.logOption = argv[++i];
+        } else if (arg == "--working-set" && i + 1 < argc) {
+            config.workingSetWindow = atol(argv[++i]);
+            if (config.workingSetWindow < 1) {
+                cout << "Working set window must be a number and greater than 0" << endl;
+                return 0;
+            }
+        } else if (arg == "--superpages") {
+            config.superpages = true;
+        } else if (arg == "--preprocess" && i + 1 < argc) {
+            preprocessFile = argv[++i];
+        } else if (arg == "--no-offsets") {
+            compactFlags &= ~COMPACT_HAS_OFFSETS;
+        } else if (arg == "--reqtype") {
+            compactFlags |= COMPACT_HAS_REQTYPE;
+        } else if (arg == "--interval" && i + 1 < argc) {
+            config.statsInterval = atol(argv[++i]);
+            if (config.statsInterval < 1) {
+                cout << "Statistics interval must be a number and greater than 0" << endl;
+                return 0;
+            }
+        } else if (arg == "--interval-format" && i + 1 < argc) {
+            intervalFormat = argv[++i];
+            if (intervalFormat != "csv" && intervalFormat != "json") {
+                cout << "Interval format must be csv or json" << endl;
+                return 0;
+            }
+        } else if (arg == "--interval-out" && i + 1 < argc) {
+            intervalFile = argv[++i];
+        } else if (arg == "--policies" && i + 1 < argc) {
+            policyList = argv[++i];
+            config.multiPolicy = true;
+        } else if (arg == "--prefetch" && i + 1 < argc) {
+            string problem = parsePrefetchSpec(argv[++i], &config.prefetch);
+            if (!problem.empty()) {
+                cout << problem << endl;
+                return 0;
+            }
+        } else if (arg == "--checkpoint-every" && i + 1 < argc) {
+            config.checkpointEvery = atol(argv[++i]);
+            if (config.checkpointEvery < 1) {
+                cout << "Checkpoint interval must be a number and greater than 0" << endl;
+                return 0;
+            }
+        } else if (arg == "--checkpoint-file" && i + 1 < argc) {
+            config.checkpointFile = argv[++i];
+        } else if (arg == "--profile" && i + 1 < argc) {
+            profileFile = argv[++i];
+            config.profile = true;
+        } else if (arg == "--resume" && i + 1 < argc) {
+            resumeFile = argv[++i];
+        } else if (arg == "--concurrent") {
+            config.concurrent = true;
+        } else if (arg == "--serial") {
+            config.parallel = false;
+        } else if (arg == "--stats") {
+#ifdef PAGING_STATS
+            config.phaseStats = true;
+#else
+            cout << "Statistics support not compiled in, rebuild with make STATS=1" << endl;
+            return 0;
+#endif
+        } else if (arg.find(".tr") != string::npos || arg == "-") {
             traceFile = arg;
+            traceFiles.push_back(arg);
         } else if (isValidInteger(arg)) {
             int bits = stoi(arg);
             if (bits < 1) {
-                cout << "Level " << levelBits.size() << " page table must be at least 1 bit" << endl;
+                cout << "Level " << config.levelBits.size() << " page table must be at least 1 bit" << endl;
                 return 0;
             }
-            levelBits.push_back(bits);
+            config.levelBits.push_back(bits);
         } else {
         }
     }
 
-    // Check total bits <= 28
-    int totalBits = 0;
-    for (int bits : levelBits) {
-        totalBits += bits;
+    string problem = PagingSim::validate(config);
+    if (!problem.empty()) {
+        cout << problem << endl;
+        return 0;
     }
-    if (totalBits > 28) {
-        cout << "Too many bits used in page tables" << endl;
+
+    vector<PolicySpec> policies;
+    if (config.multiPolicy) {
+        problem = parsePolicyList(policyList, config.nfuInterval, &policies);
+        if (problem.empty() && !resumeFile.empty()) {
+            problem = "--policies cannot be combined with --resume";
+        }
+        if (!problem.empty()) {
+            cout << problem << endl;
+            return 0;
+        }
+    }
+
+    if (config.concurrent && (!resumeFile.empty() || !preprocessFile.empty())) {
+        cout << "--concurrent cannot be combined with --resume or --preprocess" << endl;
         return 0;
     }
 
+    FILE* intervalOut = nullptr;
+    if (config.statsInterval > 0) {
+        intervalOut = intervalFile.empty() ? stderr : fopen(intervalFile.c_str(), "w");
+        if (!intervalOut) {
+            cout << "Unable to open " << intervalFile << endl;
+            return 0;
+        }
+        config.intervalOut = intervalOut;
+        config.intervalJson = intervalFormat == "json";
+    }
+
     // Simulation Setup
-    PageTable pt(levelBits, numFrames);
-    pt.nfuInterval = nfuInterval;
+    PagingSim sim(config);
+    const PageTable& pt = sim.table();
 
-    if (logOption == "bitmasks") {
-        log_bitmasks(pt.levelCount, pt.bitMaskAry.data());
+    if (config.logOption == "bitmasks") {
+        vector<uint32_t> masks = pt.bitMaskAry;
+        log_bitmasks(pt.levelCount, masks.data());
+        return 0;
+    }
+
+    if (config.concurrent) {
+        vector<TraceSource*> sources;
+        for (const string& file : traceFiles) {
+            TraceSource* replay = openTraceSource(file);
+            if (!replay || replay->granularityBits() > (unsigned int) pt.offset) {
+                if (!replay) cout << "Unable to open " << file << endl;
+                else cout << "Trace " << file << " was preprocessed for " << (1UL << replay->granularityBits())
+                          << " byte pages without offsets and cannot drive smaller pages" << endl;
+                delete replay;
+                for (TraceSource* opened : sources) delete opened;
+                return 0;
+            }
+            sources.push_back(replay);
+        }
+
+        ConcurrentPageTable shared(config.levelBits, config.numFrames, (int) sources.size());
+        shared.nfuInterval = config.nfuInterval;
+        ReplayCounters total = runConcurrentReplay(shared, sources, maxAddresses);
+        for (size_t t = 0; t < sources.size(); t++) {
+            string traceError = sources[t]->error();
+            if (!traceError.empty()) {
+                cout << "Error reading " << traceFiles[t] << ": " << traceError << endl;
+            }
+            delete sources[t];
+        }
+        log_summary(1U << shared.offset,
+                    total.pageReplacements,
+                    total.pageHits,
+                    total.accesses,
+                    shared.framesUsed(),
+                    shared.entries);
         return 0;
     }
 
     // Open Trace File
-    FILE* pFile = fopen(traceFile.c_str(), "r");
-    if (!pFile) {
+    TraceSource* source = openTraceSource(traceFile);
+    if (!source) {
         cout << "Unable to open " << traceFile << endl;
         return 0;
     }
 
-    p2AddrTr mtrace;
+    if (!preprocessFile.empty()) {
+        CompactTraceHeader header;
+        if (!writeCompactTrace(source, preprocessFile, pt.offset, compactFlags, &header)) {
+            cout << "Unable to write " << preprocessFile << endl;
+        } else {
+            unsigned long bytes = sizeof(header) + header.vpnBytes + header.offsetBytes + header.reqtypeBytes;
+            cout << "Wrote " << header.records << " records (" << bytes << " bytes, "
+                 << (double) bytes / (header.records ? header.records : 1) << " bytes/record) to "
+                 << preprocessFile << endl;
+        }
+        delete source;
+        return 0;
+    }
 
-    // Simulation Loop
-    while (NextAddress(pFile, &mtrace)) {
-        if (maxAddresses > 0 && pt.accesses >= maxAddresses) {
-            break;
+    if (source->granularityBits() > 0 && (config.logOption == "offset" || config.logOption == "va2pa")) {
+        cout << "Trace was preprocessed without offsets and cannot log " << config.logOption << endl;
+        delete source;
+        return 0;
+    }
+    if (config.ageTicks > 0 && !source->hasTimestamps()) {
+        cout << "Trace has no time stamps and cannot drive --age-ticks" << endl;
+        delete source;
+        return 0;
+    }
+    if (source->granularityBits() > (unsigned int) pt.offset) {
+        cout << "Trace was preprocessed for " << (1UL << source->granularityBits())
+             << " byte pages without offsets and cannot drive smaller pages" << endl;
+        delete source;
+        return 0;
+    }
+
+    if (!policies.empty()) {
+        MultiPolicySim multi(policies, pt.offset, config.numFrames);
+        multi.run(source, maxAddresses);
+        string traceError = source->error();
+        delete source;
+        if (!traceError.empty()) {
+            cout << "Error reading " << traceFile << ": " << traceError << endl;
+        }
+        multi.printSummary();
+        return 0;
+    }
+
+    if (!resumeFile.empty()) {
+        string problem = sim.resume(resumeFile);
+        if (problem.empty() && source->skip(pt.accesses) < (size_t) pt.accesses) {
+            problem = "Trace " + traceFile + " ends before checkpoint offset " + to_string(pt.accesses);
+        }
+        if (!problem.empty()) {
+            cout << problem << endl;
+            delete source;
+            return 0;
         }
-        pt.processAddress(mtrace.addr, logOption);
-        pt.accesses++;
     }
 
+    // Simulation Loop
+    sim.run(source, maxAddresses);
+    sim.finish();  // trailing partial window
+
     // Cleanup and Final Output
-    fclose(pFile);
-    if (logOption.empty() || logOption == "summary") {
-        log_summary(1U << pt.offset,
-                    pt.pageReplacements,
-                    pt.pageHits,
-                    pt.accesses,
-                    pt.framesUsed,
-                    pt.entries);
+    if (intervalOut && intervalOut != stderr) fclose(intervalOut);
+    string traceError = source->error();
+    delete source;
+    if (!traceError.empty()) {
+        cout << "Error reading " << traceFile << ": " << traceError << endl;
+    }
+    if (!sim.checkpointError().empty()) {
+        cout << sim.checkpointError() << endl;
     }
+    if (sim.profiler() && !sim.profiler()->writeCsv(profileFile)) {
+        cout << "Unable to write " << profileFile << endl;
+    }
+    if (config.logOption.empty() || config.logOption == "summary") {
+        sim.printSummary();
+    }
+    sim.printPhaseStats();
 
     return 0;
-}
\ No newline at end of file
+}
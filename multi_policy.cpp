@@ -0,0 +1,237 @@
+// multi_policy.cpp
+#include "multi_policy.h"
+#include <climits>
+#include <cstdlib>
+#include "log_helpers.h"
+#include "run_length.h"
+
+using namespace std;
+
+string parsePolicyList(const string& list, int defaultInterval, vector<PolicySpec>* specs) {
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == string::npos) end = list.size();
+        string name = list.substr(start, end - start);
+        start = end + 1;
+
+        PolicySpec spec;
+        spec.name = name;
+        if (name == "lru") {
+            spec.kind = POLICY_LRU;
+        } else if (name == "fifo") {
+            spec.kind = POLICY_FIFO;
+        } else if (name == "nfu") {
+            spec.kind = POLICY_NFU;
+            spec.nfuInterval = defaultInterval;
+            spec.name = "nfu:" + to_string(defaultInterval);
+        } else if (name.compare(0, 4, "nfu:") == 0) {
+            spec.kind = POLICY_NFU;
+            string interval = name.substr(4);
+            char* rest;
+            spec.nfuInterval = (int) strtol(interval.c_str(), &rest, 10);
+            if (interval.empty() || *rest != '\0' || spec.nfuInterval < 1)
+                return "Bit string update interval must be a number and greater than 0";
+        } else {
+            return "Unknown replacement policy " + name + ", expected nfu[:N], lru or fifo";
+        }
+        specs->push_back(spec);
+    }
+    return "";
+}
+
+ReplacementState::ReplacementState(const PolicySpec& spec, int numFrames)
+    : spec(spec), numFrames(numFrames) {}
+
+void ReplacementState::markAccessed(int frame) {
+    if (!inInterval[frame]) {
+        inInterval[frame] = 1;
+        accessedInInterval.push_back(frame);
+    }
+}
+
+void ReplacementState::agePages() {
+    for (int f = 0; f < framesUsed; f++) {
+        bitstring[f] >>= 1;
+    }
+    for (int f : accessedInInterval) {
+        bitstring[f] |= 0x8000;
+        inInterval[f] = 0;
+    }
+    accessedInInterval.clear();
+    nfuCounter = 0;
+}
+
+void ReplacementState::unlinkLru(int frame) {
+    int prev = lruPrev[frame], next = lruNext[frame];
+    if (prev != -1) lruNext[prev] = next; else lruHead = next;
+    if (next != -1) lruPrev[next] = prev; else lruTail = prev;
+}
+
+void ReplacementState::pushLru(int frame) {
+    lruPrev[frame] = lruTail;
+    lruNext[frame] = -1;
+    if (lruTail != -1) lruNext[lruTail] = frame; else lruHead = frame;
+    lruTail = frame;
+}
+
+int ReplacementState::selectVictim() const {
+    if (spec.kind == POLICY_LRU) return lruHead;
+    if (spec.kind == POLICY_FIFO) return fifoHand;
+
+    int victim = 0;
+    unsigned int minBits = UINT_MAX;
+    long oldest = LONG_MAX;
+    for (int f = 0; f < framesUsed; f++) {
+        if (bitstring[f] < minBits || (bitstring[f] == minBits && lastAccessTime[f] < oldest)) {
+            minBits = bitstring[f];
+            oldest = lastAccessTime[f];
+            victim = f;
+        }
+    }
+    return victim;
+}
+
+// Mirrors PageTable::processAddress: a hit is marked for the interval
+// before the aging check, a newly loaded page only if aging did not just
+// run.
+void ReplacementState::access(uint32_t page, long now) {
+    if (page >= frameOfPage.size()) frameOfPage.resize(page + 1, -1);
+    int frame = frameOfPage[page];
+    bool nfu = spec.kind == POLICY_NFU;
+
+    bool aged = false;
+    if (nfu) {
+        if (frame != -1) markAccessed(frame);
+        if (++nfuCounter >= spec.nfuInterval) {
+            agePages();
+            aged = true;
+        }
+    }
+
+    if (frame != -1) {
+        pageHits++;
+        if (nfu) {
+            lastAccessTime[frame] = now;
+        } else if (spec.kind == POLICY_LRU) {
+            unlinkLru(frame);
+            pushLru(frame);
+        }
+        return;
+    }
+
+    pageFaults++;
+    if (framesUsed < numFrames) {
+        frame = framesUsed++;
+        pageOfFrame.push_back(page);
+        bitstring.push_back(0);
+        lastAccessTime.push_back(0);
+        inInterval.push_back(0);
+        lruPrev.push_back(-1);
+        lruNext.push_back(-1);
+    } else {
+        frame = selectVictim();
+        frameOfPage[pageOfFrame[frame]] = -1;
+        pageReplacements++;
+        if (spec.kind == POLICY_LRU) unlinkLru(frame);
+        if (spec.kind == POLICY_FIFO) fifoHand = (fifoHand + 1) % numFrames;
+        if (inInterval[frame]) {
+            // The victim's slot now belongs to the new page; drop its mark
+            inInterval[frame] = 0;
+            erase(accessedInInterval, frame);
+        }
+    }
+    frameOfPage[page] = frame;
+    pageOfFrame[frame] = page;
+
+    if (nfu) {
+        bitstring[frame] = 0x8000;
+        lastAccessTime[frame] = now;
+        if (!aged) markAccessed(frame);
+    } else if (spec.kind == POLICY_LRU) {
+        pushLru(frame);
+    }
+}
+
+// Same accounting as PageTable::recordHitRun.
+void ReplacementState::hitRun(uint32_t page, long count, long now) {
+    int frame = frameOfPage[page];
+    pageHits += count;
+
+    if (spec.kind == POLICY_NFU) {
+        long remaining = count;
+        while (remaining > 0) {
+            markAccessed(frame);
+            long untilAging = spec.nfuInterval - nfuCounter;
+            if (remaining < untilAging) {
+                nfuCounter += remaining;
+                break;
+            }
+            remaining -= untilAging;
+            agePages();
+        }
+        lastAccessTime[frame] = now + count - 1;
+    } else if (spec.kind == POLICY_LRU) {
+        unlinkLru(frame);
+        pushLru(frame);
+    }
+}
+
+MultiPolicySim::MultiPolicySim(const vector<PolicySpec>& specs, unsigned int offsetBits, int numFrames)
+    : offset(offsetBits), pageIds(1 << 16) {
+    for (const PolicySpec& spec : specs) {
+        variants.emplace_back(spec, numFrames);
+    }
+}
+
+uint32_t MultiPolicySim::pageId(uint32_t vpn) {
+    bool inserted;
+    uint32_t& id = pageIds.findOrInsert(vpn, inserted);
+    if (inserted) id = pageCount++;
+    return id;
+}
+
+void MultiPolicySim::feed(span<const uint32_t> addrs) {
+    size_t i = 0;
+    while (i < addrs.size()) {
+        uint32_t vpn = addrs[i++] >> offset;
+        uint32_t page = pageId(vpn);
+        for (ReplacementState& variant : variants) {
+            variant.access(page, accesses);
+        }
+        accesses++;
+
+        size_t run = sameVpnRun(addrs.data() + i, addrs.size() - i, vpn, offset);
+        if (run > 0) {
+            for (ReplacementState& variant : variants) {
+                variant.hitRun(page, (long) run, accesses);
+            }
+            accesses += run;
+            i += run;
+        }
+    }
+}
+
+void MultiPolicySim::run(TraceSource* source, long maxAddresses) {
+    vector<p2AddrTr> block(TRACE_BLOCK_RECORDS);
+    vector<uint32_t> addrs(TRACE_BLOCK_RECORDS);
+    size_t blockSize;
+    while ((maxAddresses == 0 || accesses < maxAddresses) &&
+           (blockSize = source->nextBlock(block.data(), block.size())) > 0) {
+        if (maxAddresses > 0 && blockSize > (size_t) (maxAddresses - accesses)) {
+            blockSize = maxAddresses - accesses;
+        }
+        for (size_t k = 0; k < blockSize; k++) {
+            addrs[k] = block[k].addr;
+        }
+        feed(span<const uint32_t>(addrs.data(), blockSize));
+    }
+}
+
+void MultiPolicySim::printSummary() const {
+    log_policy_header(1U << offset, accesses);
+    for (const ReplacementState& variant : variants) {
+        log_policy_row(variant.spec.name.c_str(), variant.pageHits, variant.pageFaults,
+                       variant.pageReplacements, variant.framesUsed, accesses);
+    }
+}
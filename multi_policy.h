@@ -0,0 +1,106 @@
+// multi_policy.h
+#ifndef MULTI_POLICY_H
+#define MULTI_POLICY_H
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include "flat_vpn_map.h"
+#include "trace_source.h"
+
+enum PolicyKind { POLICY_NFU, POLICY_LRU, POLICY_FIFO };
+
+struct PolicySpec {
+    PolicyKind kind;
+    int nfuInterval = 0;  // accesses between aging passes, NFU only
+    std::string name;     // as written on the command line
+};
+
+/**
+ * @brief Parse a comma separated policy list such as "nfu:10,lru,fifo".
+ *        A bare "nfu" ages every defaultInterval accesses.
+ * @return empty on success, otherwise the reason the list was rejected
+ */
+std::string parsePolicyList(const std::string& list, int defaultInterval,
+                            std::vector<PolicySpec>* specs);
+
+/*
+ * Replacement state of one policy variant: which pages are resident and
+ * in which frame, plus whatever the policy needs to pick a victim. Pages
+ * are identified by the dense ids MultiPolicySim hands out, so residency
+ * checks are plain array lookups.
+ */
+class ReplacementState {
+public:
+    ReplacementState(const PolicySpec& spec, int numFrames);
+
+    // Simulate one access to page at time now (accesses so far).
+    void access(uint32_t page, long now);
+
+    // Simulate count further accesses to page, which the previous access
+    // made resident, starting at time now.
+    void hitRun(uint32_t page, long count, long now);
+
+    PolicySpec spec;
+    long pageHits = 0;
+    long pageFaults = 0;
+    long pageReplacements = 0;
+    int framesUsed = 0;
+
+private:
+    int selectVictim() const;
+    void agePages();
+    void markAccessed(int frame);
+    void unlinkLru(int frame);
+    void pushLru(int frame);
+
+    int numFrames;
+    std::vector<int32_t> frameOfPage;   // -1 when not resident
+    std::vector<uint32_t> pageOfFrame;
+
+    // NFU, with the same aging and tie breaking as PageTable
+    std::vector<uint16_t> bitstring;
+    std::vector<long> lastAccessTime;
+    std::vector<uint8_t> inInterval;
+    std::vector<int> accessedInInterval;
+    int nfuCounter = 0;
+
+    // LRU list threaded through frames, most recent at the tail
+    std::vector<int> lruPrev;
+    std::vector<int> lruNext;
+    int lruHead = -1;
+    int lruTail = -1;
+
+    // FIFO: frames fill in order and are replaced in place, so the oldest
+    // page is always at the hand
+    int fifoHand = 0;
+};
+
+/*
+ * Drives several replacement policies through one pass over a trace.
+ * Decoding, page number extraction, the VPN lookup and same-page run
+ * detection are done once per access and shared by every variant.
+ */
+class MultiPolicySim {
+public:
+    MultiPolicySim(const std::vector<PolicySpec>& specs, unsigned int offsetBits, int numFrames);
+
+    void feed(std::span<const uint32_t> addrs);
+    void run(TraceSource* source, long maxAddresses = 0);
+
+    // Print one summary row per variant
+    void printSummary() const;
+
+    std::vector<ReplacementState> variants;
+    long accesses = 0;
+
+private:
+    uint32_t pageId(uint32_t vpn);
+
+    unsigned int offset;
+    FlatVpnMap<uint32_t> pageIds;
+    uint32_t pageCount = 0;
+};
+
+#endif // MULTI_POLICY_H
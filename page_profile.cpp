@@ -0,0 +1,115 @@
+// page_profile.cpp
+#include "page_profile.h"
+#include <algorithm>
+#include <cstdio>
+#include "run_length.h"
+
+using namespace std;
+
+static const size_t INITIAL_SLOTS = 1 << 16;
+
+PageProfiler::PageProfiler() : pages(1 << 16), tree(INITIAL_SLOTS + 1, 0) {}
+
+void PageProfiler::add(int64_t slot, int delta) {
+    for (size_t i = slot + 1; i < tree.size(); i += i & -i) {
+        tree[i] += delta;
+    }
+}
+
+int64_t PageProfiler::prefix(int64_t slot) const {
+    int64_t sum = 0;
+    for (size_t i = slot + 1; i > 0; i -= i & -i) {
+        sum += tree[i];
+    }
+    return sum;
+}
+
+// Renumber the live slots 0..n-1 in access order and rebuild the tree
+// with room for as many new accesses again.
+void PageProfiler::compact() {
+    vector<pair<int64_t, uint32_t>> live;
+    live.reserve(pages.size());
+    pages.forEach([&live](uint32_t vpn, const PageProfile& page) {
+        if (page.lastSlot >= 0) live.push_back({page.lastSlot, vpn});
+    });
+    sort(live.begin(), live.end());
+
+    size_t slots = max(INITIAL_SLOTS, live.size() * 2);
+    tree.assign(slots + 1, 0);
+    for (size_t i = 0; i < live.size(); i++) {
+        pages.find(live[i].second)->lastSlot = (int64_t) i;
+        tree[i + 1] = 1;
+    }
+    for (size_t i = 1; i < tree.size(); i++) {
+        size_t parent = i + (i & -i);
+        if (parent < tree.size()) tree[parent] += tree[i];
+    }
+    nextSlot = (int64_t) live.size();
+}
+
+void PageProfiler::recordAccess(uint32_t vpn, bool fault) {
+    bool inserted;
+    PageProfile& page = pages.findOrInsert(vpn, inserted);
+    page.accesses++;
+    if (fault) page.faults++;
+
+    if (nextSlot + 1 >= (int64_t) tree.size()) {
+        compact();
+    }
+    if (page.lastSlot < 0) {
+        histogram[0]++;
+    } else {
+        int64_t distance = prefix(nextSlot - 1) - prefix(page.lastSlot);
+        int bucket = distance == 0 ? 1 : 2 + (63 - __builtin_clzll((uint64_t) distance));
+        histogram[bucket]++;
+        add(page.lastSlot, -1);
+    }
+    page.lastSlot = nextSlot++;
+    add(page.lastSlot, 1);
+}
+
+void PageProfiler::recordRun(uint32_t vpn, long count) {
+    pages.find(vpn)->accesses += count;
+    histogram[1] += count;
+}
+
+void PageProfiler::recordEviction(uint32_t vpn) {
+    PageProfile* page = pages.find(vpn);
+    if (page) page->evictions++;
+}
+
+void PageProfiler::recordFirstTouches(const uint32_t* addrs, size_t n, unsigned int shift) {
+    size_t i = 0;
+    while (i < n) {
+        uint32_t vpn = addrs[i++] >> shift;
+        PageProfile* page = pages.find(vpn);
+        recordAccess(vpn, !page);
+        size_t run = sameVpnRun(addrs + i, n - i, vpn, shift);
+        if (run > 0) {
+            recordRun(vpn, (long) run);
+            i += run;
+        }
+    }
+}
+
+bool PageProfiler::writeCsv(const string& path) const {
+    vector<pair<uint32_t, PageProfile>> rows;
+    rows.reserve(pages.size());
+    pages.forEach([&rows](uint32_t vpn, const PageProfile& page) {
+        rows.push_back({vpn, page});
+    });
+    sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) {
+        if (a.second.faults != b.second.faults) return a.second.faults > b.second.faults;
+        if (a.second.accesses != b.second.accesses) return a.second.accesses > b.second.accesses;
+        return a.first < b.first;
+    });
+
+    FILE* out = fopen(path.c_str(), "w");
+    if (!out) return false;
+    fprintf(out, "vpn,accesses,faults,evictions\n");
+    for (const auto& row : rows) {
+        fprintf(out, "%x,%ld,%ld,%ld\n", row.first, row.second.accesses, row.second.faults,
+                row.second.evictions);
+    }
+    return fclose(out) == 0;
+}
@@ -0,0 +1,66 @@
+// page_profile.h
+#ifndef PAGE_PROFILE_H
+#define PAGE_PROFILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "flat_vpn_map.h"
+
+// Histogram buckets: cold, distance 0, then [2^(k-1), 2^k) for k = 1..32
+const int REUSE_BUCKETS = 34;
+
+struct PageProfile {
+    long accesses = 0;
+    long faults = 0;
+    long evictions = 0;
+    int64_t lastSlot = -1;  // slot of the latest access in the reuse tree
+};
+
+/*
+ * Per-VPN access, fault and eviction counts plus an LRU stack (reuse)
+ * distance histogram (--profile). The distance of an access is the number
+ * of distinct other pages touched since the previous access to the same
+ * page, so a page with distance d hits in any fully associative LRU memory
+ * of more than d frames.
+ *
+ * Distances come from a Fenwick tree over access slots in which only each
+ * page's latest slot is set: the set slots after a page's previous slot
+ * are exactly the distinct pages touched since. When the slots run out
+ * the live ones are renumbered in order, so the tree stays proportional to
+ * the number of pages rather than the length of the trace.
+ */
+class PageProfiler {
+public:
+    PageProfiler();
+
+    void recordAccess(uint32_t vpn, bool fault);
+
+    // count further accesses to the page accessed last, each at distance 0
+    void recordRun(uint32_t vpn, long count);
+
+    void recordEviction(uint32_t vpn);
+
+    // Profile addresses simulated while no page was ever evicted, where
+    // the first access to each page is its only fault.
+    void recordFirstTouches(const uint32_t* addrs, size_t n, unsigned int shift);
+
+    /**
+     * @brief Write one row per page, most faults first, then most accesses.
+     * @return false if the file could not be written
+     */
+    bool writeCsv(const std::string& path) const;
+
+    long histogram[REUSE_BUCKETS] = {};
+
+private:
+    void add(int64_t slot, int delta);
+    int64_t prefix(int64_t slot) const;   // set slots in [0, slot]
+    void compact();
+
+    FlatVpnMap<PageProfile> pages;
+    std::vector<int32_t> tree;
+    int64_t nextSlot = 0;
+};
+
+#endif // PAGE_PROFILE_H
@@ -4,6 +4,7 @@
 #include <limits>
 #include <algorithm>
 #include "log_helpers.h"
+#include "run_length.h"
 #include <climits>
 using namespace std;
 
@@ -31,6 +32,10 @@ PageTable::PageTable(const vector<int>& levelBits, int numOfFrames) {
     rootNode = new Level(0, this);
 }
 
+PageTable::~PageTable() {
+    delete rootNode;
+}
+
 Level::Level(int d, PageTable* root) : depth(d), rootPT(root) {
     int entries = rootPT->entryCount[d];
     if (d < rootPT->levelCount - 1) {
@@ -38,12 +43,32 @@ Level::Level(int d, PageTable* root) : depth(d), rootPT(root) {
         for (int i = 0; i < entries; i++)
             nextLevel[i] = nullptr;
         rootPT->entries += entries;
+        rootPT->tableBytes += sizeof(Level) + entries * sizeof(Level*);
     } else {
         mapArray = new Map[entries];
         for (int i = 0; i < entries; i++)
             mapArray[i].frameNumber = -1;
         rootPT->entries += entries;
+        rootPT->tableBytes += sizeof(Level) + entries * sizeof(Map);
+    }
+}
+
+Level::~Level() {
+    int entries = rootPT->entryCount[depth];
+    if (nextLevel) {
+        for (int i = 0; i < entries; i++)
+            delete nextLevel[i];
+        delete[] nextLevel;
+        rootPT->tableBytes -= sizeof(Level) + entries * sizeof(Level*);
+    } else {
+        rootPT->tableBytes -= sizeof(Level) + entries * sizeof(Map);
+    }
+    if (largeMapArray) {
+        rootPT->tableBytes -= entries * sizeof(Map);
     }
+    delete[] mapArray;
+    delete[] largeMapArray;
+    rootPT->entries -= entries;
 }
 
 unsigned int PageTable::extractVPNIndex(unsigned int virtualAddress, int level) const {
@@ -55,6 +80,8 @@ Map* PageTable::searchMappedPfn(PageTable *pageTable, unsigned int virtualAddres
     for (int i = 0; i < pageTable->levelCount; i++) {
         unsigned int vpnIndex = pageTable->extractVPNIndex(virtualAddress, i);
         if (i < pageTable->levelCount - 1) {
+            if (currentLvl->largeMapArray && currentLvl->largeMapArray[vpnIndex].frameNumber != -1)
+                return &currentLvl->largeMapArray[vpnIndex];
             Level* nextLevel = currentLvl->nextLevel[vpnIndex];
             if (!nextLevel) return nullptr;
             currentLvl = nextLevel;
@@ -77,18 +104,167 @@ void PageTable::insertMapForVpn2Pfn(PageTable *pageTable, unsigned int virtualAd
             currentLvl = currentLvl->nextLevel[vpnIndex];
         } else {
             Map &map = currentLvl->mapArray[vpnIndex];
+            if (map.frameNumber == -1 && frame != -1) currentLvl->mappedCount++;
             map.frameNumber = frame;
             if (frame != -1) {
                 map.bitstring = 1ULL << 15;
+                map.dirty = false;
+                map.inWindow = false;
+                if (!pageTable->frameOwner.empty()) pageTable->frameOwner[frame] = &map;
+            }
+        }
+    }
+}
+
+void PageTable::agePages() {
+    PHASE_TIMER(this->phaseStats, PHASE_AGING);
+    for (Map* page : this->loadedPagesCollection) {
+        page->bitstring >>= 1;
+    }
+    for (Map* page : this->accessedPagesInInterval) {
+        page->bitstring |= (1ULL << 15);
+    }
+    this->accessedPagesInInterval.clear();
+    this->nfuCounter = 0;
+}
+
+// Move trace time forward by one record's delta and run the aging passes
+// whose tick passed in the gap before it. A pass falling on the record's
+// own tick is left to processAddress, so that with one tick per record
+// aging matches -b exactly. An unknown time stamp counts as no time.
+void PageTable::advanceTicks(uint32_t delta) {
+    if (delta != 0xFFFFFFFF) this->ticks += delta;
+    if (this->ticks <= this->nextAgingTick) return;
+
+    long passes = (this->ticks - this->nextAgingTick - 1) / this->ageTicks + 1;
+    this->nextAgingTick += passes * this->ageTicks;
+    // Sixteen shifts clear every bitstring; further passes change nothing
+    for (long k = 0; k < min(passes, 17L); k++) {
+        agePages();
+    }
+}
+
+// Process trace records one at a time, so each access keeps its own time
+// stamp and request type. With an interval reporter a report is made at
+// every reporting boundary.
+void PageTable::processRecords(const p2AddrTr* records, size_t count, const string& logOption) {
+    for (size_t i = 0; i < count; i++) {
+        if (this->ageTicks > 0) {
+            advanceTicks(records[i].time);
+        }
+        processAddress(records[i].addr, logOption, records[i].reqtype == MEMWRITE);
+        this->accesses++;
+        if (this->intervalReporter && this->accesses % this->intervalReporter->every == 0) {
+            this->intervalReporter->report(*this);
+        }
+    }
+}
+
+// Process a block of addresses, counting accesses. With an interval
+// reporter the block is cut at every reporting boundary.
+void PageTable::processAddresses(const uint32_t* addrs, size_t count, const string& logOption) {
+    if (!this->intervalReporter) {
+        processSegment(addrs, count, logOption);
+        return;
+    }
+
+    long every = this->intervalReporter->every;
+    while (count > 0) {
+        size_t untilReport = static_cast<size_t>(every - this->accesses % every);
+        size_t n = min(count, untilReport);
+        processSegment(addrs, n, logOption);
+        if (n == untilReport) {
+            this->intervalReporter->report(*this);
+        }
+        addrs += n;
+        count -= n;
+    }
+}
+
+// When nothing is logged per access, each run of addresses on the same page
+// after the first is folded into one batch of hits.
+void PageTable::processSegment(const uint32_t* addrs, size_t count, const string& logOption) {
+    bool batchHits = logOption.empty() || logOption == "summary";
+    size_t i = 0;
+    while (i < count) {
+        unsigned int virtualAddress = addrs[i++];
+        processAddress(virtualAddress, logOption);
+        this->accesses++;
+        if (!batchHits || i == count) continue;
+
+        size_t run = sameVpnRun(addrs + i, count - i, virtualAddress >> this->offset, this->offset);
+        if (run > 0) {
+            Map* map;
+            {
+                PHASE_TIMER(this->phaseStats, PHASE_WALK);
+                map = searchMappedPfn(this, virtualAddress);
+            }
+            recordHitRun(map, static_cast<long>(run));
+            if (this->profiler) {
+                this->profiler->recordRun(virtualAddress >> this->offset, static_cast<long>(run));
+            }
+            i += run;
+        }
+    }
+}
+
+// Account count consecutive hits on an already mapped page exactly as that
+// many processAddress calls would, including NFU aging and working-set
+// sweeps that fall inside the run.
+void PageTable::recordHitRun(Map* map, long count) {
+    while (this->workingSetWindow > 0 && this->accesses + count > this->nextWorkingSetSweep) {
+        long before = this->nextWorkingSetSweep - this->accesses;
+        recordHits(map, before);
+        sweepWorkingSet();
+        count -= before;
+    }
+    recordHits(map, count);
+}
+
+void PageTable::recordHits(Map* map, long count) {
+    if (this->nfuInterval > 0 && this->ageTicks == 0) {
+        long remaining = count;
+        while (remaining > 0) {
+            this->accessedPagesInInterval.insert(map);
+            long untilAging = this->nfuInterval - this->nfuCounter;
+            if (remaining < untilAging) {
+                this->nfuCounter += remaining;
+                break;
             }
+            remaining -= untilAging;
+            agePages();
         }
     }
+
+    this->pageHits += count;
+    if (map->large) {
+        this->largePageHits += count;
+    }
+    if (this->costModel) {
+        this->costModel->repeatHits(count);
+    }
+    if (this->workingSetWindow > 0) {
+        this->residentFrameSum += count * framesInUse();
+    }
+    this->accesses += count;
+    map->lastAccessTime = this->accesses - 1;
 }
 
-void PageTable::processAddress(unsigned int virtualAddress, string logOption) {
+void PageTable::processAddress(unsigned int virtualAddress, const string& logOption, bool write) {
     unsigned int vpn = virtualAddress >> this->offset;
 
-    Map* map = searchMappedPfn(this, virtualAddress);
+    if (this->workingSetWindow > 0 && this->accesses >= this->nextWorkingSetSweep) {
+        sweepWorkingSet();
+    }
+
+    Map* map;
+    {
+        PHASE_TIMER(this->phaseStats, PHASE_WALK);
+        map = searchMappedPfn(this, virtualAddress);
+    }
+    if (this->profiler) {
+        this->profiler->recordAccess(vpn, map == nullptr);
+    }
 
     bool aged_this_time = false;
 
@@ -97,74 +273,87 @@ void PageTable::processAddress(unsigned int virtualAddress, string logOption) {
         this->accessedPagesInInterval.insert(map);
     }
 
-    // NFU aging logic
-    if (this->nfuInterval > 0) {
+    // NFU aging logic, on trace time when ageTicks is set
+    if (this->nfuInterval > 0 && this->ageTicks > 0) {
+        if (this->ticks == this->nextAgingTick) {
+            this->nextAgingTick += this->ageTicks;
+            agePages();
+            aged_this_time = true;
+        }
+    } else if (this->nfuInterval > 0) {
         this->nfuCounter++;
         if (this->nfuCounter >= this->nfuInterval) {
-            for (Map* page : this->loadedPagesCollection) {
-                page->bitstring >>= 1;
-                if (this->accessedPagesInInterval.find(page) != this->accessedPagesInInterval.end()) {
-                    page->bitstring |= (1ULL << 15);
-                }
-            }
-            this->accessedPagesInInterval.clear();
-            this->nfuCounter = 0;
+            agePages();
             aged_this_time = true;
         }
     }
 
     if (map != nullptr) {
         this->pageHits++;
+        if (map->large) {
+            this->largePageHits++;
+        }
         map->lastAccessTime = this->accesses;
+        if (write) map->dirty = true;
+        if (this->costModel) {
+            // One TLB entry covers a whole superpage, whose walk stops a level early
+            if (map->large) this->costModel->access(map->vpn, this->levelCount - 1, false);
+            else this->costModel->access(vpn, this->levelCount, false);
+        }
         if (logOption == "vpn2pfn_pr") {
-            log_mapping(vpn, map->frameNumber, 0, 0, "hit");
+            PHASE_TIMER(this->phaseStats, PHASE_LOGGING);
+            log_mapping(vpn, frameForAddress(map, virtualAddress), 0, 0, "hit");
+        }
+        if (map->prefetched) {
+            map->prefetched = false;
+            this->prefetchUsed++;
+            if (this->prefetcher) {
+                prefetchPages(this->prefetcher->onPrefetchHit(vpn), virtualAddress);
+            }
         }
     } else {
         this->pageFaults++;
         Map* newMap;
 
-        if (this->framesUsed < this->numFrames) {
-            insertMapForVpn2Pfn(this, virtualAddress, this->framesUsed);
-            newMap = searchMappedPfn(this, virtualAddress);
+        if (!this->freeFrames.empty() || this->framesUsed < this->numFrames) {
+            int frame;
+            if (!this->freeFrames.empty()) {
+                frame = this->freeFrames.back();
+                this->freeFrames.pop_back();
+            } else {
+                frame = this->framesUsed++;
+            }
+            {
+                PHASE_TIMER(this->phaseStats, PHASE_INSERT);
+                insertMapForVpn2Pfn(this, virtualAddress, frame);
+                newMap = searchMappedPfn(this, virtualAddress);
+            }
             newMap->vpn = vpn;
             newMap->lastAccessTime = this->accesses;
-            this->loadedPagesCollection.push_back(newMap);
-            this->framesUsed++;
+            newMap->dirty = write;
+            addLoadedPage(newMap);
             if (this->nfuInterval > 0 && !aged_this_time) {
                 this->accessedPagesInInterval.insert(newMap);
             }
             if (logOption == "vpn2pfn_pr") {
+                PHASE_TIMER(this->phaseStats, PHASE_LOGGING);
                 log_mapping(vpn, newMap->frameNumber, 0, 0, "miss");
             }
         } else {
-            Map* victim = nullptr;
-            unsigned long long minBits = ULLONG_MAX;
-            long oldest = LONG_MAX;
-
-            for (Map* page : this->loadedPagesCollection) {
-                if (page->bitstring < minBits || (page->bitstring == minBits && page->lastAccessTime < oldest)) {
-                    minBits = page->bitstring;
-                    oldest = page->lastAccessTime;
-                    victim = page;
-                }
-            }
-
-            int reusedFrame = victim->frameNumber;
+            Map* victim;
+            int reusedFrame = evictVictim(&victim);
             unsigned int victimVPN = victim->vpn;
             uint16_t victimBits = static_cast<uint16_t>(victim->bitstring);
 
-            victim->frameNumber = -1;
-            this->pageReplacements++;
-
-            insertMapForVpn2Pfn(this, virtualAddress, reusedFrame);
-            newMap = searchMappedPfn(this, virtualAddress);
+            {
+                PHASE_TIMER(this->phaseStats, PHASE_INSERT);
+                insertMapForVpn2Pfn(this, virtualAddress, reusedFrame);
+                newMap = searchMappedPfn(this, virtualAddress);
+            }
             newMap->vpn = vpn;
             newMap->lastAccessTime = this->accesses;
-
-            auto it = find(this->loadedPagesCollection.begin(), this->loadedPagesCollection.end(), victim);
-            if (it != this->loadedPagesCollection.end()) {
-                *it = newMap;
-            }
+            newMap->dirty = write;
+            replaceLoadedPage(victim, newMap);
 
             if (this->nfuInterval > 0 && !aged_this_time) {
                 this->accessedPagesInInterval.erase(victim);
@@ -172,11 +361,29 @@ void PageTable::processAddress(unsigned int virtualAddress, string logOption) {
             }
 
             if (logOption == "vpn2pfn_pr") {
+                PHASE_TIMER(this->phaseStats, PHASE_LOGGING);
                 log_mapping(vpn, reusedFrame, victimVPN, victimBits, "miss");
             }
         }
+
+        if (this->costModel) {
+            this->costModel->access(vpn, this->levelCount, true);
+        }
+        if (this->superpages) {
+            tryPromote(virtualAddress);
+        }
+        if (this->prefetcher) {
+            prefetchPages(this->prefetcher->onFault(vpn), virtualAddress);
+        }
     }
 
+    if (this->workingSetWindow > 0) {
+        this->residentFrameSum += framesInUse();
+    }
+
+    if (logOption.empty() || logOption == "summary") return;
+
+    PHASE_TIMER(this->phaseStats, PHASE_LOGGING);
     if (logOption == "offset") {
         unsigned int offsetMask = (1U << this->offset) - 1;
         unsigned int offsetVal = virtualAddress & offsetMask;
@@ -187,11 +394,336 @@ void PageTable::processAddress(unsigned int virtualAddress, string logOption) {
             vpns[i] = extractVPNIndex(virtualAddress, i);
         }
         Map* map = searchMappedPfn(this, virtualAddress);
-        unsigned int pfn = (map != nullptr) ? map->frameNumber : 0;
+        unsigned int pfn = (map != nullptr) ? frameForAddress(map, virtualAddress) : 0;
         log_vpns_pfn(this->levelCount, vpns, pfn);
     } else if (logOption == "va2pa") {
         Map* map = searchMappedPfn(this, virtualAddress);
-        unsigned int pa = (map != nullptr) ? (static_cast<unsigned int>(map->frameNumber) << this->offset) | (virtualAddress & ((1U << this->offset) - 1)) : 0;
+        unsigned int pa = (map != nullptr) ? (frameForAddress(map, virtualAddress) << this->offset) | (virtualAddress & ((1U << this->offset) - 1)) : 0;
         log_va2pa(virtualAddress, pa);
     }
-}
\ No newline at end of file
+}
+
+// Take the victim's frame away from it and return the frame, or -1 if
+// every loaded page is keep or, with spareWindow, in the read-ahead
+// windows. The victim is chosen by NFU, or by the WSClock hand in
+// working-set mode.
+int PageTable::evictVictim(Map** victimOut, const Map* keep, bool spareWindow) {
+    Map* victim;
+    {
+        PHASE_TIMER(this->phaseStats, PHASE_VICTIM);
+        victim = this->workingSetWindow > 0 ? workingSetVictim(keep, spareWindow)
+                                                : selectVictim(keep, spareWindow);
+    }
+    *victimOut = victim;
+    if (!victim) return -1;
+
+    int reusedFrame = victim->frameNumber;
+    victim->frameNumber = -1;
+    this->pageReplacements++;
+    releasePage(victim);
+
+    // Evicting a superpage releases its whole span; keep the base
+    // frame for the incoming page and hand the rest to the free list.
+    if (victim->large) {
+        for (int f = reusedFrame + largePageFrames() - 1; f > reusedFrame; f--) {
+            this->freeFrames.push_back(f);
+        }
+        this->demotions++;
+    } else if (this->superpages) {
+        findLeaf(victim->vpn << this->offset)->mappedCount--;
+    }
+    return reusedFrame;
+}
+
+// Account for a page leaving memory: profile it, write it back if dirty
+// and drop its TLB entries.
+void PageTable::releasePage(Map* victim) {
+    if (this->profiler) {
+        this->profiler->recordEviction(victim->vpn);
+    }
+    if (victim->prefetched) {
+        victim->prefetched = false;
+        this->prefetchEvicted++;
+        if (this->prefetcher) this->prefetcher->onPrefetchEvicted();
+    }
+
+    unsigned int pages = victim->large ? largePageFrames() : 1;
+    if (victim->dirty) {
+        victim->dirty = false;
+        this->dirtyWritebacks += pages;
+        if (this->costModel) this->costModel->writeback(pages);
+    }
+    if (this->costModel) {
+        this->costModel->invalidate(victim->vpn, pages);
+    }
+}
+
+// Load the prefetcher's candidates for the access to virtualAddress.
+// Prefetched pages start with an empty bitstring, so NFU would otherwise
+// evict the window being loaded, and the previous window the stream is
+// still consuming, before they are used. Read-ahead therefore never
+// evicts pages of either window, and stops if nothing else is left;
+// demand faults may still evict them.
+void PageTable::prefetchPages(const vector<unsigned int>& vpns, unsigned int virtualAddress) {
+    unsigned int pageCount = 1U << (32 - this->offset);
+    size_t issued = 0;
+    while (issued < vpns.size() && vpns[issued] < pageCount &&
+           prefetchPage(vpns[issued], searchMappedPfn(this, virtualAddress))) {
+        issued++;
+    }
+    if (issued == 0) return;
+
+    // The new window replaces the previous one. Look pages up again, as
+    // they may have been evicted or folded into a superpage since.
+    for (unsigned int vpn : this->readAheadWindow) {
+        Map* map = searchMappedPfn(this, vpn << this->offset);
+        if (map) map->inWindow = false;
+    }
+    this->readAheadWindow.assign(vpns.begin(), vpns.begin() + issued);
+    for (unsigned int vpn : this->readAheadWindow) {
+        Map* map = searchMappedPfn(this, vpn << this->offset);
+        if (map) map->inWindow = true;
+    }
+}
+
+// Map vpn ahead of demand through the normal insert path. The page starts
+// unreferenced, so NFU evicts it first if it is never used. Returns false
+// if no frame could be had without evicting keep or read-ahead pages.
+bool PageTable::prefetchPage(unsigned int vpn, const Map* keep) {
+    unsigned int virtualAddress = vpn << this->offset;
+    if (searchMappedPfn(this, virtualAddress)) return true;
+
+    Map* victim = nullptr;
+    int frame;
+    if (!this->freeFrames.empty()) {
+        frame = this->freeFrames.back();
+        this->freeFrames.pop_back();
+    } else if (this->framesUsed < this->numFrames) {
+        frame = this->framesUsed++;
+    } else {
+        frame = evictVictim(&victim, keep, true);
+        if (frame == -1) return false;
+    }
+
+    Map* newMap;
+    {
+        PHASE_TIMER(this->phaseStats, PHASE_INSERT);
+        insertMapForVpn2Pfn(this, virtualAddress, frame);
+        newMap = searchMappedPfn(this, virtualAddress);
+    }
+    newMap->vpn = vpn;
+    newMap->bitstring = 0;
+    newMap->lastAccessTime = this->accesses;
+    newMap->prefetched = true;
+    newMap->inWindow = true;
+
+    if (victim) {
+        replaceLoadedPage(victim, newMap);
+        this->accessedPagesInInterval.erase(victim);
+    } else {
+        addLoadedPage(newMap);
+    }
+    this->prefetchIssued++;
+
+    if (this->superpages) {
+        tryPromote(virtualAddress);
+    }
+    return true;
+}
+
+void PageTable::addLoadedPage(Map* map) {
+    map->slot = static_cast<int>(this->loadedPagesCollection.size());
+    this->loadedPagesCollection.push_back(map);
+}
+
+// Put map in the evicted victim's place, keeping frame order.
+void PageTable::replaceLoadedPage(Map* victim, Map* map) {
+    map->slot = victim->slot;
+    this->loadedPagesCollection[victim->slot] = map;
+    victim->slot = -1;
+}
+
+// Renumber slots after pages were removed from loadedPagesCollection.
+void PageTable::reindexLoadedPages() {
+    for (size_t i = 0; i < this->loadedPagesCollection.size(); i++) {
+        this->loadedPagesCollection[i]->slot = static_cast<int>(i);
+    }
+}
+
+// NFU victim: the page with the smallest aging bitstring, ties broken by
+// the least recent access. keep, and with spareWindow the read-ahead
+// windows, are never chosen; nullptr if nothing else is loaded.
+Map* PageTable::selectVictim(const Map* keep, bool spareWindow) const {
+    Map* victim = nullptr;
+    unsigned long long minBits = ULLONG_MAX;
+    long oldest = LONG_MAX;
+
+    for (Map* page : this->loadedPagesCollection) {
+        if (page == keep || (spareWindow && page->inWindow)) continue;
+        if (page->bitstring < minBits || (page->bitstring == minBits && page->lastAccessTime < oldest)) {
+            minBits = page->bitstring;
+            oldest = page->lastAccessTime;
+            victim = page;
+        }
+    }
+    return victim;
+}
+
+// WSClock: advance the hand around the frame ring to the first page not
+// referenced within the window. If every resident page is in the working
+// set, memory is overcommitted and NFU picks the victim instead.
+Map* PageTable::workingSetVictim(const Map* keep, bool spareWindow) {
+    int ring = this->framesUsed;
+    for (int scanned = 0; scanned < ring; scanned++) {
+        Map* page = this->frameOwner[this->clockHand];
+        this->clockHand = (this->clockHand + 1) % ring;
+        if (page && page != keep && !(spareWindow && page->inWindow) &&
+            this->accesses - page->lastAccessTime > this->workingSetWindow) return page;
+    }
+    return selectVictim(keep, spareWindow);
+}
+
+// Run every workingSetWindow accesses: scan the whole frame ring and give
+// every page not referenced within the window back to the free list, so
+// the resident set shrinks to the working set. The scan does not move
+// clockHand, which only advances when a fault needs a victim.
+void PageTable::sweepWorkingSet() {
+    long now = this->accesses;
+    this->nextWorkingSetSweep = now + this->workingSetWindow;
+
+    long before = this->reclaimed;
+    for (int f = this->framesUsed - 1; f >= 0; f--) {
+        Map* page = this->frameOwner[f];
+        if (!page || now - page->lastAccessTime <= this->workingSetWindow) continue;
+
+        releasePage(page);
+        page->frameNumber = -1;
+        this->frameOwner[f] = nullptr;
+        this->freeFrames.push_back(f);
+        this->accessedPagesInInterval.erase(page);
+        this->reclaimed++;
+    }
+    if (this->reclaimed > before) {
+        this->loadedPagesCollection.erase(
+            remove_if(this->loadedPagesCollection.begin(), this->loadedPagesCollection.end(),
+                      [](Map* page) { return page->frameNumber == -1; }),
+            this->loadedPagesCollection.end());
+        reindexLoadedPages();
+    }
+}
+
+// Resident pages referenced within the last workingSetWindow accesses.
+long PageTable::workingSetSize() const {
+    long size = 0;
+    for (Map* page : this->loadedPagesCollection) {
+        if (this->accesses - page->lastAccessTime <= this->workingSetWindow) size++;
+    }
+    return size;
+}
+
+long PageTable::framesInUse() const {
+    return this->framesUsed - (long) this->freeFrames.size();
+}
+
+unsigned int PageTable::largePageFrames() const {
+    return this->entryCount[this->levelCount - 1];
+}
+
+unsigned int PageTable::frameForAddress(const Map* map, unsigned int virtualAddress) const {
+    unsigned int frame = static_cast<unsigned int>(map->frameNumber);
+    if (map->large) {
+        frame += extractVPNIndex(virtualAddress, this->levelCount - 1);
+    }
+    return frame;
+}
+
+Level* PageTable::findLeaf(unsigned int virtualAddress) const {
+    Level* currentLvl = this->rootNode;
+    for (int i = 0; i < this->levelCount - 1 && currentLvl; i++) {
+        currentLvl = currentLvl->nextLevel[extractVPNIndex(virtualAddress, i)];
+    }
+    return currentLvl;
+}
+
+// Give the level above the leaves its array of superpage entries.
+void PageTable::addLargeMaps(Level* parent) {
+    if (parent->largeMapArray) return;
+    int parentEntries = this->entryCount[this->levelCount - 2];
+    parent->largeMapArray = new Map[parentEntries];
+    this->tableBytes += parentEntries * sizeof(Map);
+    for (int i = 0; i < parentEntries; i++)
+        parent->largeMapArray[i].large = true;
+}
+
+// Promote the leaf holding virtualAddress to a superpage once every entry is
+// mapped. Frames already forming an aligned run are promoted in place;
+// otherwise the pages migrate to a fresh aligned run and their old frames go
+// to the free list. The superpage entry lives in the parent level, so
+// lookups in that region stop one level early.
+void PageTable::tryPromote(unsigned int virtualAddress) {
+    if (this->levelCount < 2) return;
+
+    Level* parent = this->rootNode;
+    for (int i = 0; i < this->levelCount - 2; i++) {
+        parent = parent->nextLevel[extractVPNIndex(virtualAddress, i)];
+        if (!parent) return;
+    }
+    unsigned int parentIndex = extractVPNIndex(virtualAddress, this->levelCount - 2);
+    Level* leaf = parent->nextLevel[parentIndex];
+    int span = static_cast<int>(largePageFrames());
+    if (!leaf || leaf->mappedCount < span) return;
+
+    int base = leaf->mapArray[0].frameNumber;
+    bool contiguous = base % span == 0;
+    for (int i = 1; contiguous && i < span; i++) {
+        contiguous = leaf->mapArray[i].frameNumber == base + i;
+    }
+    if (!contiguous) {
+        int alignedBase = (this->framesUsed + span - 1) / span * span;
+        if (alignedBase + span > this->numFrames) return;
+        for (int f = alignedBase - 1; f >= this->framesUsed; f--) {
+            this->freeFrames.push_back(f);
+        }
+        for (int i = span - 1; i >= 0; i--) {
+            this->freeFrames.push_back(leaf->mapArray[i].frameNumber);
+        }
+        this->framesUsed = alignedBase + span;
+        base = alignedBase;
+        this->migrations++;
+    }
+    addLargeMaps(parent);
+
+    Map &large = parent->largeMapArray[parentIndex];
+    large.frameNumber = base;
+    large.vpn = leaf->mapArray[0].vpn;
+    large.bitstring = 0;
+    large.lastAccessTime = 0;
+    large.dirty = false;
+    bool accessed = false;
+    for (int i = 0; i < span; i++) {
+        Map* page = &leaf->mapArray[i];
+        large.bitstring |= page->bitstring;
+        large.dirty = large.dirty || page->dirty;
+        large.lastAccessTime = max(large.lastAccessTime, page->lastAccessTime);
+        if (this->accessedPagesInInterval.erase(page)) accessed = true;
+    }
+    if (accessed) {
+        this->accessedPagesInInterval.insert(&large);
+    }
+
+    Map* first = leaf->mapArray;
+    Map* last = leaf->mapArray + span;
+    this->loadedPagesCollection.erase(
+        remove_if(this->loadedPagesCollection.begin(), this->loadedPagesCollection.end(),
+                  [first, last](Map* page) { return page >= first && page < last; }),
+        this->loadedPagesCollection.end());
+    reindexLoadedPages();
+    addLoadedPage(&large);
+
+    if (this->costModel) {
+        this->costModel->invalidate(large.vpn, span);
+    }
+    parent->nextLevel[parentIndex] = nullptr;
+    delete leaf;
+    this->promotions++;
+}
@@ -1,8 +1,18 @@
+// pagetable.h
+#ifndef PAGETABLE_H
+#define PAGETABLE_H
+
 #include <vector>
 #include <set>
 #include <deque>
 #include <cstdint>
 #include <string>
+#include "phase_stats.h"
+#include "interval_stats.h"
+#include "prefetch.h"
+#include "page_profile.h"
+#include "cost_model.h"
+#include "vaddr_tracereader.h"
 using namespace std;
 
 
@@ -11,9 +21,14 @@ class PageTable;
 class Map {
 public:
     int frameNumber = -1;
-    uint16_t bitstring = 0;  // 16-bit as per spec
+    uint16_t bitstring = 0;       // 16-bit as per spec
+    bool large : 1 = false;       // maps a whole leaf span as one superpage
+    bool prefetched : 1 = false;  // loaded ahead of demand and not used yet
+    bool dirty : 1 = false;       // written since it was loaded
+    bool inWindow : 1 = false;    // in the latest read-ahead window
     long lastAccessTime = 0;
     unsigned int vpn = 0;
+    int slot = -1;                // index in loadedPagesCollection while loaded
 };
 
 class Level {
@@ -22,6 +37,8 @@ public:
     PageTable* rootPT;
     Level** nextLevel = nullptr;
     Map* mapArray = nullptr;
+    Map* largeMapArray = nullptr;  // superpage entries, only on the level above the leaves
+    int mappedCount = 0;           // leaf entries currently holding a frame
 
     Level(int d, PageTable* root);
     ~Level();  // Declared here; implemented in .cpp
@@ -34,14 +51,25 @@ public:
     vector<unsigned int> shiftAry;
     vector<unsigned int> entryCount;
     unsigned int entries;  // Changed to unsigned
+    unsigned long tableBytes = 0;  // memory held by Level nodes and their arrays
     int nfuInterval;
     int nfuCounter = 0;
+    long ageTicks = 0;       // age every ageTicks trace ticks instead of every nfuInterval accesses
+    long ticks = 0;          // trace time of the current record
+    long nextAgingTick = 0;
     int offset;
 
     Level* rootNode = nullptr;
 
     int numFrames;
     int framesUsed = 0;
+    vector<int> freeFrames;  // frames returned when a superpage is evicted
+
+    bool superpages = false;
+    long largePageHits = 0;
+    long promotions = 0;
+    long demotions = 0;
+    long migrations = 0;
 
     deque<Map*> loadedPagesCollection;
     set<Map*> accessedPagesInInterval;
@@ -51,10 +79,67 @@ public:
     long accesses = 0;
     long pageReplacements = 0;
 
+    IntervalReporter* intervalReporter = nullptr;  // --interval stream, if any
+
+    Prefetcher* prefetcher = nullptr;  // --prefetch policy, if any
+    PageProfiler* profiler = nullptr;  // --profile, if any
+    vector<unsigned int> readAheadWindow;  // pages of the latest window issued
+    long prefetchIssued = 0;
+    long prefetchUsed = 0;
+    long prefetchEvicted = 0;  // evicted before their first use; pages folded
+                               // into a superpage unused count as neither
+
+    CostModel* costModel = nullptr;  // --latency, if any
+    long dirtyWritebacks = 0;
+
+    // Working-set mode (--working-set): pages not referenced within the
+    // last workingSetWindow accesses go back to freeFrames. frameOwner is
+    // the WSClock ring, indexed by frame, nullptr for a free frame.
+    long workingSetWindow = 0;
+    long nextWorkingSetSweep = 0;
+    vector<Map*> frameOwner;
+    int clockHand = 0;
+    long reclaimed = 0;
+    long residentFrameSum = 0;  // frames in use summed over every access
+
+#ifdef PAGING_STATS
+    PhaseStats phaseStats;
+#endif
+
     PageTable(const vector<int>& levelBits, int numOfFrames);
+    ~PageTable();
+    PageTable(const PageTable&) = delete;
+    PageTable& operator=(const PageTable&) = delete;
 
     unsigned int extractVPNIndex(unsigned int virtualAddress, int level) const;
     Map* searchMappedPfn(PageTable *pageTable, unsigned int virtualAddress);
     void insertMapForVpn2Pfn(PageTable *pageTable, unsigned int virtualAddress, int frame);
-    void processAddress(unsigned int virtualAddress, std::string logOption);
-};
\ No newline at end of file
+    void processAddress(unsigned int virtualAddress, const std::string& logOption, bool write = false);
+    void processAddresses(const uint32_t* addrs, size_t count, const std::string& logOption);
+    void processRecords(const p2AddrTr* records, size_t count, const std::string& logOption);
+    void processSegment(const uint32_t* addrs, size_t count, const std::string& logOption);
+    void recordHitRun(Map* map, long count);
+    void recordHits(Map* map, long count);
+    void agePages();
+    void advanceTicks(uint32_t delta);
+    Map* selectVictim(const Map* keep = nullptr, bool spareWindow = false) const;
+    Map* workingSetVictim(const Map* keep = nullptr, bool spareWindow = false);
+    void sweepWorkingSet();
+    long workingSetSize() const;
+    long framesInUse() const;
+    int evictVictim(Map** victimOut, const Map* keep = nullptr, bool spareWindow = false);
+    void addLoadedPage(Map* map);
+    void replaceLoadedPage(Map* victim, Map* map);
+    void reindexLoadedPages();
+    void releasePage(Map* victim);
+    void prefetchPages(const vector<unsigned int>& vpns, unsigned int virtualAddress);
+    bool prefetchPage(unsigned int vpn, const Map* keep);
+
+    unsigned int largePageFrames() const;
+    unsigned int frameForAddress(const Map* map, unsigned int virtualAddress) const;
+    Level* findLeaf(unsigned int virtualAddress) const;
+    void addLargeMaps(Level* parent);
+    void tryPromote(unsigned int virtualAddress);
+};
+
+#endif // PAGETABLE_H
@@ -0,0 +1,274 @@
+// pagingsim.cpp
+#include "pagingsim.h"
+#include <algorithm>
+#include <stdexcept>
+#include "pagetable.h"
+#include "trace_source.h"
+#include "first_touch.h"
+#include "log_helpers.h"
+#include "checkpoint.h"
+
+using namespace std;
+
+string PagingSim::validate(const PagingSimConfig& config) {
+    if (config.levelBits.empty()) return "At least one page table level is required";
+    int totalBits = 0;
+    for (size_t i = 0; i < config.levelBits.size(); i++) {
+        if (config.levelBits[i] < 1)
+            return "Level " + to_string(i) + " page table must be at least 1 bit";
+        totalBits += config.levelBits[i];
+    }
+    if (totalBits > 28) return "Too many bits used in page tables";
+    if (config.numFrames < 1) return "Number of available frames must be a number and greater than 0";
+    if (config.nfuInterval < 1) return "Bit string update interval must be a number and greater than 0";
+    if (config.superpages && config.levelBits.size() < 2)
+        return "Superpages require at least two page table levels";
+    if (config.workingSetWindow < 0) return "Working set window must be a number and greater than 0";
+    if (config.workingSetWindow > 0 && config.superpages)
+        return "Working-set mode cannot be combined with superpages";
+    if (config.ageTicks < 0) return "Aging tick interval must be a number and greater than 0";
+    if (config.modelCosts && config.latency.tlbEntries < 1)
+        return "Number of TLB entries must be a number and greater than 0";
+    if (config.modelCosts && config.checkpointEvery > 0)
+        return "The cost model cannot be checkpointed";
+    if (config.statsInterval < 0) return "Statistics interval must be a number and greater than 0";
+    if (config.checkpointEvery < 0) return "Checkpoint interval must be a number and greater than 0";
+    if (config.checkpointEvery > 0 && config.checkpointFile.empty())
+        return "Checkpoint interval needs a checkpoint file";
+#ifndef PAGING_STATS
+    if (config.phaseStats) return "Statistics support not compiled in, rebuild with make STATS=1";
+#endif
+    if (config.multiPolicy && config.concurrent) return "--concurrent cannot be combined with --policies";
+    if ((config.multiPolicy || config.concurrent) && (config.superpages || config.statsInterval > 0 || config.phaseStats ||
+                               config.prefetch.kind != PREFETCH_NONE || config.checkpointEvery > 0 ||
+                               config.profile || config.ageTicks > 0 || config.modelCosts ||
+                               config.workingSetWindow > 0 ||
+                               !(config.logOption.empty() || config.logOption == "summary" ||
+                                 config.logOption == "bitmasks"))) {
+        return string(config.multiPolicy ? "--policies" : "--concurrent") +
+               " only supports the summary log and cannot be combined with "
+               "--superpages, --interval, --stats, --prefetch, --profile, --age-ticks, "
+               "--latency, --working-set or checkpoints";
+    }
+    return "";
+}
+
+PagingSim::PagingSim(const PagingSimConfig& config) : config(config) {
+    string problem = validate(config);
+    if (!problem.empty()) throw invalid_argument(problem);
+
+    pt = new PageTable(config.levelBits, config.numFrames);
+    pt->nfuInterval = config.nfuInterval;
+    pt->ageTicks = config.ageTicks;
+    pt->nextAgingTick = config.ageTicks;
+    pt->superpages = config.superpages;
+    if (config.workingSetWindow > 0) {
+        pt->workingSetWindow = config.workingSetWindow;
+        pt->nextWorkingSetSweep = config.workingSetWindow;
+        pt->frameOwner.assign(config.numFrames, nullptr);
+    }
+    if (config.statsInterval > 0) {
+        pt->intervalReporter = new IntervalReporter(config.statsInterval,
+                                                    config.intervalOut ? config.intervalOut : stderr,
+                                                    config.intervalJson,
+                                                    config.workingSetWindow > 0);
+    }
+    if (config.profile) {
+        pt->profiler = new PageProfiler();
+    }
+    if (config.prefetch.kind != PREFETCH_NONE) {
+        prefetcher = new Prefetcher(config.prefetch);
+        pt->prefetcher = prefetcher;
+    }
+    if (config.modelCosts) {
+        costModel = new CostModel(config.latency);
+        pt->costModel = costModel;
+    }
+#ifdef PAGING_STATS
+    pt->phaseStats.enabled = config.phaseStats;
+    if (config.phaseStats) hwCounters = new HwCounters();
+#endif
+}
+
+PagingSim::~PagingSim() {
+    delete pt->intervalReporter;
+    delete prefetcher;
+    delete costModel;
+    delete pt->profiler;
+#ifdef PAGING_STATS
+    delete hwCounters;
+#endif
+    delete pt;
+}
+
+void PagingSim::feed(span<const uint32_t> addrs) {
+    pt->processAddresses(addrs.data(), addrs.size(), config.logOption);
+}
+
+void PagingSim::feedRecords(span<const p2AddrTr> records) {
+    if (config.ageTicks > 0 || costModel) {
+        pt->processRecords(records.data(), records.size(), config.logOption);
+        return;
+    }
+    scratch.resize(records.size());
+    for (size_t k = 0; k < records.size(); k++) {
+        scratch[k] = records[k].addr;
+    }
+    feed(scratch);
+}
+
+static size_t nextTracedBlock([[maybe_unused]] PageTable& pt, TraceSource* source,
+                              p2AddrTr* records, size_t maxRecords) {
+    PHASE_TIMER(pt.phaseStats, PHASE_TRACE_READ);
+    return source->nextBlock(records, maxRecords);
+}
+
+void PagingSim::run(TraceSource* source, long maxAddresses) {
+#ifdef PAGING_STATS
+    if (hwCounters) hw_counters_start(hwCounters);
+#endif
+
+    // Without per-access logs, the prefix of the trace that needs no page
+    // replacement can be simulated in parallel
+    if (config.parallel && !config.superpages && config.workingSetWindow == 0 && !config.phaseStats && !pt->intervalReporter && !prefetcher &&
+        config.checkpointEvery == 0 && config.ageTicks == 0 && !costModel && pt->accesses == 0 &&
+        (config.logOption.empty() || config.logOption == "summary") && firstTouchEligible(*pt)) {
+        runFirstTouchParallel(*pt, source, maxAddresses);
+    }
+
+    vector<p2AddrTr> block(TRACE_BLOCK_RECORDS);
+    size_t blockSize;
+    while ((maxAddresses == 0 || pt->accesses < maxAddresses) &&
+           (blockSize = nextTracedBlock(*pt, source, block.data(), block.size())) > 0) {
+        if (maxAddresses > 0 && blockSize > (size_t) (maxAddresses - pt->accesses)) {
+            blockSize = maxAddresses - pt->accesses;
+        }
+        // Periodic checkpoints land exactly on multiples of checkpointEvery
+        const p2AddrTr* records = block.data();
+        while (blockSize > 0) {
+            size_t n = blockSize;
+            long every = config.checkpointEvery;
+            if (every > 0) n = min(n, (size_t) (every - pt->accesses % every));
+            feedRecords(span<const p2AddrTr>(records, n));
+            if (every > 0 && pt->accesses % every == 0 && !checkpoint(config.checkpointFile)) {
+                checkpointProblem = "Unable to write " + config.checkpointFile;
+            }
+            records += n;
+            blockSize -= n;
+        }
+    }
+
+#ifdef PAGING_STATS
+    if (hwCounters) hw_counters_stop(hwCounters);
+#endif
+}
+
+void PagingSim::finish() {
+    if (pt->intervalReporter) {
+        pt->intervalReporter->report(*pt);
+    }
+}
+
+bool PagingSim::checkpoint(const string& path) const {
+    return writeCheckpoint(*pt, path);
+}
+
+string PagingSim::resume(const string& path) {
+    if (costModel) return "Checkpoint " + path + " cannot be resumed under the cost model";
+    if (pt->profiler) return "Checkpoint " + path + " cannot be resumed with --profile";
+    if (prefetcher) return "Checkpoint " + path + " cannot be resumed with --prefetch";
+    string problem = loadCheckpoint(*pt, path);
+    if (!problem.empty()) return "Checkpoint " + path + " " + problem;
+    if (pt->intervalReporter) pt->intervalReporter->rebase(*pt);
+    // A snapshot taken without tick-based aging has no aging tick pending
+    if (pt->ageTicks > 0 && pt->nextAgingTick == 0) pt->nextAgingTick = pt->ticks + pt->ageTicks;
+    // Sweeps fall on multiples of the window; the one due at the snapshot
+    // itself, if any, runs before the next access
+    long window = pt->workingSetWindow;
+    if (window > 0) pt->nextWorkingSetSweep = max((pt->accesses + window - 1) / window * window, window);
+    return "";
+}
+
+const PageProfiler* PagingSim::profiler() const {
+    return pt->profiler;
+}
+
+PagingSimStats PagingSim::stats() const {
+    PagingSimStats s;
+    s.pageSize = 1UL << pt->offset;
+    s.accesses = pt->accesses;
+    s.pageHits = pt->pageHits;
+    s.pageFaults = pt->pageFaults;
+    s.pageReplacements = pt->pageReplacements;
+    s.framesAllocated = pt->framesUsed;
+    s.framesInUse = pt->framesInUse();
+    s.pageTableEntries = pt->entries;
+    s.pageTableBytes = pt->tableBytes;
+    s.largePageHits = pt->largePageHits;
+    s.promotions = pt->promotions;
+    s.migrations = pt->migrations;
+    s.demotions = pt->demotions;
+    s.prefetchIssued = pt->prefetchIssued;
+    s.prefetchUsed = pt->prefetchUsed;
+    s.prefetchEvicted = pt->prefetchEvicted;
+    s.dirtyWritebacks = pt->dirtyWritebacks;
+    s.reclaimed = pt->reclaimed;
+    if (pt->workingSetWindow > 0 && pt->accesses > 0) {
+        s.averageResidentFrames = (double) pt->residentFrameSum / pt->accesses;
+    }
+    if (costModel) {
+        s.tlbHits = costModel->tlbHits;
+        s.tlbMisses = costModel->tlbMisses;
+        s.accessTimeNs = costModel->totalNs;
+    }
+    return s;
+}
+
+void PagingSim::printSummary() const {
+    log_summary(1U << pt->offset,
+                pt->pageReplacements,
+                pt->pageHits,
+                pt->accesses,
+                pt->framesUsed,
+                pt->entries);
+    if (pt->superpages) {
+        log_superpages((unsigned long) pt->largePageFrames() << pt->offset,
+                       pt->promotions,
+                       pt->migrations,
+                       pt->demotions,
+                       pt->largePageHits,
+                       pt->accesses);
+    }
+    if (pt->workingSetWindow > 0) {
+        log_working_set(pt->workingSetWindow,
+                        pt->reclaimed,
+                        pt->residentFrameSum,
+                        pt->framesUsed,
+                        pt->accesses);
+    }
+    if (prefetcher) {
+        log_prefetch(pt->prefetchIssued,
+                     pt->prefetchUsed,
+                     pt->prefetchEvicted,
+                     pt->pageFaults);
+    }
+    if (costModel) {
+        log_cost_model(costModel->totalNs,
+                       costModel->latency.tlbHit,
+                       costModel->tlbHits,
+                       costModel->tlbMisses,
+                       pt->dirtyWritebacks,
+                       pt->accesses);
+    }
+    if (pt->profiler) {
+        log_reuse_histogram(pt->profiler->histogram, REUSE_BUCKETS);
+    }
+}
+
+void PagingSim::printPhaseStats() const {
+#ifdef PAGING_STATS
+    if (hwCounters) {
+        log_phase_stats(&pt->phaseStats, hwCounters, pt->accesses);
+    }
+#endif
+}
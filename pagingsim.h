@@ -0,0 +1,144 @@
+// pagingsim.h
+// Public interface of libpagingsim: a demand-paging simulator with a
+// multi-level page table and NFU replacement that is fed address batches.
+#ifndef PAGINGSIM_H
+#define PAGINGSIM_H
+
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <string>
+#include <vector>
+#include "vaddr_tracereader.h"
+#include "prefetch.h"
+#include "cost_model.h"
+
+class PageTable;
+class PageProfiler;
+class TraceSource;
+struct HwCounters;
+
+struct PagingSimConfig {
+    std::vector<int> levelBits;  // VPN bits per page table level, root first
+    int numFrames = 999999;
+    int nfuInterval = 10;        // accesses between NFU aging passes
+    long ageTicks = 0;           // if set, age every ageTicks trace ticks instead
+    bool superpages = false;     // promote fully populated leaves
+    long workingSetWindow = 0;   // if set, free pages unreferenced for this many accesses
+    PrefetchSpec prefetch;       // read-ahead on faults, none by default
+    bool profile = false;        // per-VPN counts and reuse distances
+    bool modelCosts = false;     // TLB and effective access time model
+    LatencyConfig latency;       // its latencies and TLB size
+    std::string logOption;       // per-access log written to stdout, "" for none
+    bool parallel = true;        // allow the parallel first-touch path in run()
+    bool phaseStats = false;     // per-phase timers, needs a PAGING_STATS build
+
+    long checkpointEvery = 0;    // snapshot to checkpointFile every N accesses in run()
+    std::string checkpointFile;
+
+    // The simulation will run under MultiPolicySim (--policies) or the
+    // concurrent replay (--concurrent) instead, which only produce the
+    // summary; validate() rejects the options they cannot honour.
+    bool multiPolicy = false;
+    bool concurrent = false;
+
+    long statsInterval = 0;      // emit windowed statistics every N accesses
+    FILE* intervalOut = nullptr; // destination for them, stderr if null
+    bool intervalJson = false;
+};
+
+struct PagingSimStats {
+    unsigned long pageSize = 0;
+    long accesses = 0;
+    long pageHits = 0;
+    long pageFaults = 0;
+    long pageReplacements = 0;
+    long framesAllocated = 0;
+    long framesInUse = 0;
+    unsigned long pageTableEntries = 0;
+    unsigned long pageTableBytes = 0;
+    long largePageHits = 0;
+    long promotions = 0;
+    long migrations = 0;
+    long demotions = 0;
+    long prefetchIssued = 0;
+    long prefetchUsed = 0;
+    long prefetchEvicted = 0;
+    long dirtyWritebacks = 0;
+    long reclaimed = 0;          // pages freed by working-set sweeps
+    double averageResidentFrames = 0;  // frames in use, averaged over accesses
+    long tlbHits = 0;            // cost model counters, zero unless modelCosts
+    long tlbMisses = 0;
+    double accessTimeNs = 0;     // modeled time of every access
+};
+
+/*
+ * One simulated address space. All state lives in the instance, so any
+ * number of simulators can run side by side in one process.
+ */
+class PagingSim {
+public:
+    // Throws std::invalid_argument with validate()'s message on a bad config.
+    explicit PagingSim(const PagingSimConfig& config);
+    ~PagingSim();
+    PagingSim(const PagingSim&) = delete;
+    PagingSim& operator=(const PagingSim&) = delete;
+
+    // Empty if config describes a valid simulator, otherwise the reason.
+    static std::string validate(const PagingSimConfig& config);
+
+    // Simulate a batch of virtual addresses in trace order. The batch is
+    // read in place and not retained. Bare addresses carry no time stamps
+    // or writes, so they neither advance tick-based aging nor dirty pages.
+    void feed(std::span<const uint32_t> addrs);
+
+    // Simulate a batch of decoded trace records. Record times drive aging
+    // when config.ageTicks is set, and MEMWRITE records dirty their page.
+    void feedRecords(std::span<const p2AddrTr> records);
+
+    // Drive the simulator from a trace until it ends or maxAddresses
+    // records have been simulated (0 for no limit).
+    void run(TraceSource* source, long maxAddresses = 0);
+
+    // Close the current statistics window; call once input is exhausted.
+    void finish();
+
+    // Snapshot the simulator to path; false if it could not be written.
+    bool checkpoint(const std::string& path) const;
+
+    // Continue from a snapshot instead of an empty table. Call before any
+    // input is fed; the trace must then be positioned at stats().accesses.
+    // Snapshots hold no profile or cost model state, so neither may be on.
+    // Returns empty on success, otherwise the reason it was rejected.
+    std::string resume(const std::string& path);
+
+    // Non-empty if a periodic checkpoint in run() could not be written.
+    const std::string& checkpointError() const { return checkpointProblem; }
+
+    PagingSimStats stats() const;
+
+    // Print log_summary, plus superpage, working-set, prefetch and cost
+    // model statistics and the reuse distance histogram when they are
+    // enabled.
+    void printSummary() const;
+
+    // Print the --stats phase breakdown; does nothing unless phaseStats is
+    // set in a PAGING_STATS build.
+    void printPhaseStats() const;
+
+    const PageTable& table() const { return *pt; }
+
+    // Per-page profile, or nullptr unless config.profile is set.
+    const PageProfiler* profiler() const;
+
+private:
+    PagingSimConfig config;
+    PageTable* pt;
+    HwCounters* hwCounters = nullptr;
+    Prefetcher* prefetcher = nullptr;
+    CostModel* costModel = nullptr;
+    std::vector<uint32_t> scratch;
+    std::string checkpointProblem;
+};
+
+#endif // PAGINGSIM_H
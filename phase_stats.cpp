@@ -0,0 +1,101 @@
+// phase_stats.cpp
+#include "phase_stats.h"
+
+#ifdef PAGING_STATS
+
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+static const char* phaseNames[PHASE_COUNT] = {
+    "trace read", "page walk", "NFU aging", "victim search", "insert", "logging"
+};
+
+static const char* counterNames[3] = {"cycles", "cache misses", "dTLB misses"};
+
+#ifdef __linux__
+static int openCounter(uint32_t type, uint64_t config, int groupFd) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = groupFd == -1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0);
+}
+#endif
+
+void hw_counters_start(HwCounters* counters) {
+#ifdef __linux__
+    const uint64_t dtlbReadMiss = PERF_COUNT_HW_CACHE_DTLB |
+                                  (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    counters->fds[0] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1);
+    if (counters->fds[0] < 0) return;
+    counters->fds[1] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, counters->fds[0]);
+    counters->fds[2] = openCounter(PERF_TYPE_HW_CACHE, dtlbReadMiss, counters->fds[0]);
+    for (int i = 0; i < 3; i++)
+        counters->opened[i] = counters->fds[i] >= 0;
+    counters->available = true;
+    ioctl(counters->fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(counters->fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+    (void) counters;
+#endif
+}
+
+void hw_counters_stop(HwCounters* counters) {
+#ifdef __linux__
+    if (!counters->available) return;
+    ioctl(counters->fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    for (int i = 0; i < 3; i++) {
+        if (counters->fds[i] < 0) continue;
+        if (read(counters->fds[i], &counters->values[i], sizeof(uint64_t)) != sizeof(uint64_t))
+            counters->values[i] = 0;
+        close(counters->fds[i]);
+        counters->fds[i] = -1;
+    }
+#else
+    (void) counters;
+#endif
+}
+
+void log_phase_stats(const PhaseStats* stats, const HwCounters* counters,
+                     unsigned long int numOfAddresses) {
+    uint64_t total = 0;
+    for (int i = 0; i < PHASE_COUNT; i++)
+        total += stats->cycles[i];
+
+    printf("Phase breakdown (cycles):\n");
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        double share = total ? (double) stats->cycles[i] / (double) total * 100.0 : 0.0;
+        double perCall = stats->calls[i] ? (double) stats->cycles[i] / (double) stats->calls[i] : 0.0;
+        printf("  %-14s %14lu %6.2f%%  calls %12lu  avg %8.1f\n", phaseNames[i],
+               (unsigned long) stats->cycles[i], share, (unsigned long) stats->calls[i], perCall);
+    }
+    if (numOfAddresses)
+        printf("  %-14s %14.1f\n", "per access", (double) total / (double) numOfAddresses);
+
+    if (!counters->available) {
+        printf("Hardware counters: unavailable\n");
+    } else {
+        printf("Hardware counters (main loop):\n");
+        for (int i = 0; i < 3; i++) {
+            if (!counters->opened[i])
+                printf("  %-14s %14s\n", counterNames[i], "n/a");
+            else
+                printf("  %-14s %14lu\n", counterNames[i], (unsigned long) counters->values[i]);
+        }
+    }
+    fflush(stdout);
+}
+
+#endif // PAGING_STATS
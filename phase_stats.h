@@ -0,0 +1,88 @@
+// phase_stats.h
+#ifndef PHASE_STATS_H
+#define PHASE_STATS_H
+
+#include <cstdint>
+
+/*
+ * Per-phase cycle accounting for the simulation hot path. Everything here
+ * is compiled only when PAGING_STATS is defined (make STATS=1); otherwise
+ * PHASE_TIMER expands to nothing and the hot path carries no extra code.
+ */
+enum StatsPhase {
+    PHASE_TRACE_READ,
+    PHASE_WALK,
+    PHASE_AGING,
+    PHASE_VICTIM,
+    PHASE_INSERT,
+    PHASE_LOGGING,
+    PHASE_COUNT
+};
+
+#ifdef PAGING_STATS
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+inline uint64_t readCycles() { return __rdtsc(); }
+#else
+#include <ctime>
+inline uint64_t readCycles() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+
+struct PhaseStats {
+    bool enabled = false;
+    uint64_t cycles[PHASE_COUNT] = {};
+    uint64_t calls[PHASE_COUNT] = {};
+};
+
+class PhaseTimer {
+public:
+    PhaseTimer(PhaseStats& stats, StatsPhase phase) : stats(stats), phase(phase) {
+        if (stats.enabled) start = readCycles();
+    }
+    ~PhaseTimer() {
+        if (stats.enabled) {
+            stats.cycles[phase] += readCycles() - start;
+            stats.calls[phase]++;
+        }
+    }
+
+private:
+    PhaseStats& stats;
+    StatsPhase phase;
+    uint64_t start = 0;
+};
+
+/* Hardware counters read with perf_event_open around the main loop. */
+struct HwCounters {
+    int fds[3] = {-1, -1, -1};
+    bool opened[3] = {};
+    uint64_t values[3] = {};
+    bool available = false;
+};
+
+void hw_counters_start(HwCounters* counters);
+void hw_counters_stop(HwCounters* counters);
+
+/**
+ * @brief Print the per-phase breakdown and hardware counters, meant to
+ *        follow log_summary.
+ */
+void log_phase_stats(const PhaseStats* stats, const HwCounters* counters,
+                     unsigned long int numOfAddresses);
+
+#define PHASE_TIMER_CAT2(a, b) a##b
+#define PHASE_TIMER_CAT(a, b) PHASE_TIMER_CAT2(a, b)
+#define PHASE_TIMER(stats, phase) PhaseTimer PHASE_TIMER_CAT(phaseTimer_, __LINE__)(stats, phase)
+
+#else
+
+#define PHASE_TIMER(stats, phase)
+
+#endif // PAGING_STATS
+
+#endif // PHASE_STATS_H
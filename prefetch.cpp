@@ -0,0 +1,102 @@
+// prefetch.cpp
+#include "prefetch.h"
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+
+// Defaults for the forms without an explicit depth
+static const int STRIDE_DEPTH = 4;
+static const int ADAPTIVE_MAX = 32;
+static const int ADAPTIVE_INITIAL = 4;
+
+string parsePrefetchSpec(const string& text, PrefetchSpec* spec) {
+    size_t colon = text.find(':');
+    string name = text.substr(0, colon);
+    string depth = colon == string::npos ? "" : text.substr(colon + 1);
+
+    if (name == "seq") {
+        spec->kind = PREFETCH_SEQ;
+        if (depth.empty()) return "Prefetch policy seq needs a depth, e.g. seq:4";
+    } else if (name == "stride") {
+        spec->kind = PREFETCH_STRIDE;
+        spec->depth = STRIDE_DEPTH;
+    } else if (name == "adaptive") {
+        spec->kind = PREFETCH_ADAPTIVE;
+        spec->depth = ADAPTIVE_MAX;
+    } else {
+        return "Unknown prefetch policy " + text + ", expected seq:K, stride[:K] or adaptive[:MAX]";
+    }
+
+    if (!depth.empty()) {
+        char* rest;
+        spec->depth = (int) strtol(depth.c_str(), &rest, 10);
+        if (*rest != '\0' || spec->depth < 1)
+            return "Prefetch depth must be a number and greater than 0";
+    }
+    return "";
+}
+
+void Prefetcher::issueWindow(unsigned int first, int size, long step) {
+    long vpn = first;
+    for (int k = 0; k < size && vpn >= 0; k++, vpn += step) {
+        candidates.push_back((unsigned int) vpn);
+    }
+    window = size;
+    marker = first;
+    windowEnd = (unsigned int) vpn;
+}
+
+const vector<unsigned int>& Prefetcher::onFault(unsigned int vpn) {
+    candidates.clear();
+    long stride = haveFault ? (long) vpn - (long) lastFault : 0;
+
+    switch (spec.kind) {
+    case PREFETCH_SEQ:
+        for (int k = 1; k <= spec.depth; k++) {
+            candidates.push_back(vpn + k);
+        }
+        break;
+    case PREFETCH_STRIDE:
+        if (stride != 0 && stride == lastStride && (long) vpn + stride >= 0) {
+            issueWindow(vpn + stride, spec.depth, stride);
+        } else {
+            window = 0;
+        }
+        break;
+    case PREFETCH_ADAPTIVE:
+        if (stride == 1 || (window > 0 && vpn == windowEnd)) {
+            // sequential: the stream continues past what was read ahead
+            issueWindow(vpn + 1, min(max(window * 2, ADAPTIVE_INITIAL), spec.depth), 1);
+        } else {
+            window = 0;
+        }
+        break;
+    case PREFETCH_NONE:
+        break;
+    }
+
+    haveFault = true;
+    lastStride = stride;
+    lastFault = vpn;
+    return candidates;
+}
+
+const vector<unsigned int>& Prefetcher::onPrefetchHit(unsigned int vpn) {
+    candidates.clear();
+    if (window > 0 && vpn == marker) {
+        if (spec.kind == PREFETCH_STRIDE) {
+            issueWindow(windowEnd, spec.depth, lastStride);
+        } else if (spec.kind == PREFETCH_ADAPTIVE) {
+            issueWindow(windowEnd, min(window * 2, spec.depth), 1);
+        }
+    }
+    return candidates;
+}
+
+void Prefetcher::onPrefetchEvicted() {
+    // Read-ahead is being thrashed out before use, shrink the window
+    if (spec.kind == PREFETCH_ADAPTIVE) {
+        window /= 2;
+    }
+}
@@ -0,0 +1,65 @@
+// prefetch.h
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <string>
+#include <vector>
+
+enum PrefetchKind { PREFETCH_NONE, PREFETCH_SEQ, PREFETCH_STRIDE, PREFETCH_ADAPTIVE };
+
+struct PrefetchSpec {
+    PrefetchKind kind = PREFETCH_NONE;
+    int depth = 0;  // pages per prefetch, or the window limit for adaptive
+};
+
+/**
+ * @brief Parse a --prefetch policy: seq:K, stride[:K] or adaptive[:MAX].
+ * @return empty on success, otherwise the reason the policy was rejected
+ */
+std::string parsePrefetchSpec(const std::string& text, PrefetchSpec* spec);
+
+/*
+ * Decides which pages to load ahead of demand (--prefetch). The page
+ * table asks for candidates when a fault loads a page and when a
+ * prefetched page is used for the first time, and reports prefetched
+ * pages evicted unused so adaptive read-ahead can back off.
+ *
+ *   seq:K        the K pages after every faulting page
+ *   stride:K     K pages along the stride when two consecutive faults
+ *                repeat the same distance; using the first of them loads
+ *                the next K
+ *   adaptive:MAX Linux style read-ahead: a fault right after the previous
+ *                one opens a window that doubles, up to MAX pages, each
+ *                time the stream continues; touching the first page of
+ *                the last window loads the next window before it faults
+ */
+class Prefetcher {
+public:
+    explicit Prefetcher(const PrefetchSpec& spec) : spec(spec) {}
+
+    // Pages to load after a demand fault on vpn, nearest first.
+    const std::vector<unsigned int>& onFault(unsigned int vpn);
+
+    // Pages to load after the first access to prefetched page vpn.
+    const std::vector<unsigned int>& onPrefetchHit(unsigned int vpn);
+
+    // A prefetched page was evicted before it was used.
+    void onPrefetchEvicted();
+
+private:
+    void issueWindow(unsigned int first, int size, long step);
+
+    PrefetchSpec spec;
+    std::vector<unsigned int> candidates;
+
+    bool haveFault = false;
+    unsigned int lastFault = 0;
+    long lastStride = 0;
+
+    // last window issued by stride or adaptive read-ahead
+    int window = 0;               // its size in pages
+    unsigned int windowEnd = 0;   // the page that would follow it
+    unsigned int marker = 0;      // first page of the last window
+};
+
+#endif // PREFETCH_H
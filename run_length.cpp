@@ -0,0 +1,64 @@
+// run_length.cpp
+#include "run_length.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RUN_LENGTH_X86 1
+#endif
+
+static size_t sameVpnRunScalar(const uint32_t* addrs, size_t n, uint32_t vpn, unsigned int shift) {
+    size_t i = 0;
+    while (i < n && (addrs[i] >> shift) == vpn) i++;
+    return i;
+}
+
+#ifdef RUN_LENGTH_X86
+
+__attribute__((target("sse2")))
+static size_t sameVpnRunSse2(const uint32_t* addrs, size_t n, uint32_t vpn, unsigned int shift) {
+    const __m128i want = _mm_set1_epi32((int) vpn);
+    const __m128i count = _mm_cvtsi32_si128((int) shift);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_srl_epi32(_mm_loadu_si128((const __m128i*) (addrs + i)), count);
+        unsigned int mask = (unsigned int) _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, want)));
+        if (mask != 0xF) return i + __builtin_ctz(~mask);
+    }
+    return i + sameVpnRunScalar(addrs + i, n - i, vpn, shift);
+}
+
+__attribute__((target("avx2")))
+static size_t sameVpnRunAvx2(const uint32_t* addrs, size_t n, uint32_t vpn, unsigned int shift) {
+    const __m256i want = _mm256_set1_epi32((int) vpn);
+    const __m128i count = _mm_cvtsi32_si128((int) shift);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_srl_epi32(_mm256_loadu_si256((const __m256i*) (addrs + i)), count);
+        unsigned int mask = (unsigned int) _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, want)));
+        if (mask != 0xFF) return i + __builtin_ctz(~mask);
+    }
+    return i + sameVpnRunScalar(addrs + i, n - i, vpn, shift);
+}
+
+typedef size_t (*RunKernel)(const uint32_t*, size_t, uint32_t, unsigned int);
+
+static RunKernel pickKernel() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return sameVpnRunAvx2;
+    if (__builtin_cpu_supports("sse2")) return sameVpnRunSse2;
+    return sameVpnRunScalar;
+}
+
+static const RunKernel runKernel = pickKernel();
+
+size_t sameVpnRun(const uint32_t* addrs, size_t n, uint32_t vpn, unsigned int shift) {
+    return runKernel(addrs, n, vpn, shift);
+}
+
+#else
+
+size_t sameVpnRun(const uint32_t* addrs, size_t n, uint32_t vpn, unsigned int shift) {
+    return sameVpnRunScalar(addrs, n, vpn, shift);
+}
+
+#endif
@@ -0,0 +1,21 @@
+// run_length.h
+#ifndef RUN_LENGTH_H
+#define RUN_LENGTH_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Count how many leading addresses share a virtual page number.
+ *
+ * Uses AVX2 or SSE2 when the CPU supports them, chosen once at runtime.
+ *
+ * @param addrs - virtual addresses to scan
+ * @param n - number of addresses
+ * @param vpn - page number the run must match
+ * @param shift - page offset bits (addr >> shift is the page number)
+ * @return length of the prefix of addrs whose page number equals vpn
+ */
+size_t sameVpnRun(const uint32_t* addrs, size_t n, uint32_t vpn, unsigned int shift);
+
+#endif // RUN_LENGTH_H
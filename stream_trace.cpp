@@ -0,0 +1,192 @@
+// stream_trace.cpp
+#include "stream_trace.h"
+#include <cstring>
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace std;
+
+// Decoded blocks allowed to queue up ahead of the simulator.
+static const size_t MAX_QUEUED_BLOCKS = 8;
+static const size_t INPUT_CHUNK = 1 << 16;
+
+StreamCodec sniffCodec(const unsigned char* magic, size_t len) {
+    if (len >= 2 && magic[0] == 0x1F && magic[1] == 0x8B) return CODEC_GZIP;
+    if (len >= 4 && magic[0] == 0x28 && magic[1] == 0xB5 && magic[2] == 0x2F && magic[3] == 0xFD)
+        return CODEC_ZSTD;
+    return CODEC_NONE;
+}
+
+StreamTraceSource::StreamTraceSource(FILE* file, StreamCodec codec, const string& prefix)
+    : file(file), codec(codec), prefix(prefix), swapBytes(::endian() == BIG) {
+    pending.resize(TRACE_BLOCK_RECORDS * sizeof(p2AddrTr));
+    worker = thread(&StreamTraceSource::produce, this);
+}
+
+StreamTraceSource::~StreamTraceSource() {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    space.notify_all();
+    worker.join();
+    if (file != stdin) fclose(file);
+}
+
+string StreamTraceSource::error() const {
+    lock_guard<mutex> guard(lock);
+    return failure;
+}
+
+size_t StreamTraceSource::nextBlock(p2AddrTr* records, size_t maxRecords) {
+    if (currentPos >= current.size()) {
+        unique_lock<mutex> guard(lock);
+        ready.wait(guard, [this] { return !blocks.empty() || finished; });
+        if (blocks.empty()) return 0;
+        if (current.capacity()) spare.push_back(move(current));
+        current = move(blocks.front());
+        blocks.pop_front();
+        currentPos = 0;
+        guard.unlock();
+        space.notify_one();
+    }
+
+    size_t n = min(maxRecords, current.size() - currentPos);
+    memcpy(records, current.data() + currentPos, n * sizeof(p2AddrTr));
+    currentPos += n;
+    return n;
+}
+
+bool StreamTraceSource::readInput(vector<char>& buf, size_t& len) {
+    if (!prefix.empty()) {
+        len = prefix.size();
+        memcpy(buf.data(), prefix.data(), len);
+        prefix.clear();
+        return true;
+    }
+    len = fread(buf.data(), 1, buf.size(), file);
+    return len > 0;
+}
+
+void StreamTraceSource::pushBlock(vector<p2AddrTr>& block) {
+    if (swapBytes) {
+        for (p2AddrTr& rec : block) {
+            rec.addr = swap_endian(rec.addr);
+            rec.time = swap_endian(rec.time);
+        }
+    }
+    unique_lock<mutex> guard(lock);
+    space.wait(guard, [this] { return blocks.size() < MAX_QUEUED_BLOCKS || stopping; });
+    blocks.push_back(move(block));
+    guard.unlock();
+    ready.notify_one();
+}
+
+// Append decoded bytes, handing over every completed block of records.
+bool StreamTraceSource::emit(const char* data, size_t len) {
+    while (len > 0) {
+        size_t n = min(len, pending.size() - pendingLen);
+        memcpy(pending.data() + pendingLen, data, n);
+        pendingLen += n;
+        data += n;
+        len -= n;
+        if (pendingLen == pending.size()) {
+            vector<p2AddrTr> block;
+            {
+                lock_guard<mutex> guard(lock);
+                if (stopping) return false;
+                if (!spare.empty()) {
+                    block = move(spare.back());
+                    spare.pop_back();
+                }
+            }
+            block.resize(TRACE_BLOCK_RECORDS);
+            memcpy(block.data(), pending.data(), pendingLen);
+            pendingLen = 0;
+            pushBlock(block);
+        }
+    }
+    return true;
+}
+
+void StreamTraceSource::produce() {
+    vector<char> in(INPUT_CHUNK);
+    vector<char> out(INPUT_CHUNK * 4);
+    string problem;
+    size_t len;
+
+    if (codec == CODEC_NONE) {
+        while (readInput(in, len) && emit(in.data(), len)) {}
+    } else if (codec == CODEC_GZIP) {
+        z_stream zs;
+        memset(&zs, 0, sizeof(zs));
+        inflateInit2(&zs, 16 + MAX_WBITS);
+        bool inMember = false;
+        bool going = true;
+        while (going && readInput(in, len)) {
+            zs.next_in = reinterpret_cast<Bytef*>(in.data());
+            zs.avail_in = (uInt) len;
+            while (going && zs.avail_in > 0) {
+                zs.next_out = reinterpret_cast<Bytef*>(out.data());
+                zs.avail_out = (uInt) out.size();
+                int ret = inflate(&zs, Z_NO_FLUSH);
+                inMember = true;
+                if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+                    problem = "corrupt gzip stream";
+                    going = false;
+                    break;
+                }
+                going = emit(out.data(), out.size() - zs.avail_out);
+                if (ret == Z_STREAM_END) {
+                    // Concatenated gzip members decode as one stream.
+                    inflateReset(&zs);
+                    inMember = false;
+                }
+            }
+        }
+        if (going && inMember) problem = "truncated gzip stream";
+        inflateEnd(&zs);
+    } else {
+#ifdef HAVE_ZSTD
+        ZSTD_DStream* zds = ZSTD_createDStream();
+        ZSTD_initDStream(zds);
+        size_t hint = 0;
+        bool going = true;
+        while (going && readInput(in, len)) {
+            ZSTD_inBuffer input = {in.data(), len, 0};
+            while (going && input.pos < input.size) {
+                ZSTD_outBuffer output = {out.data(), out.size(), 0};
+                hint = ZSTD_decompressStream(zds, &output, &input);
+                if (ZSTD_isError(hint)) {
+                    problem = string("corrupt zstd stream: ") + ZSTD_getErrorName(hint);
+                    going = false;
+                    break;
+                }
+                going = emit(out.data(), output.pos);
+            }
+        }
+        if (going && hint != 0) problem = "truncated zstd stream";
+        ZSTD_freeDStream(zds);
+#else
+        problem = "zstd support not compiled in, rebuild with make ZSTD=1";
+#endif
+    }
+
+    // Hand over the trailing partial block; a partial record is dropped,
+    // as fread does for raw traces.
+    size_t tail = pendingLen / sizeof(p2AddrTr);
+    if (tail > 0) {
+        vector<p2AddrTr> block(tail);
+        memcpy(block.data(), pending.data(), tail * sizeof(p2AddrTr));
+        pushBlock(block);
+    }
+
+    {
+        lock_guard<mutex> guard(lock);
+        failure = problem;
+        finished = true;
+    }
+    ready.notify_all();
+}
@@ -0,0 +1,66 @@
+// stream_trace.h
+#ifndef STREAM_TRACE_H
+#define STREAM_TRACE_H
+
+#include <cstdio>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "trace_source.h"
+
+enum StreamCodec { CODEC_NONE, CODEC_GZIP, CODEC_ZSTD };
+
+/*
+ * Trace records decoded on a background thread from a byte stream: stdin,
+ * a pipe, or a gzip/zstd compressed file. The thread decompresses into
+ * blocks of p2AddrTr and hands them over through a bounded queue, so
+ * decompression overlaps with simulation.
+ */
+class StreamTraceSource : public TraceSource {
+public:
+    // file is owned by the source; prefix holds bytes already read from it
+    // while sniffing the format.
+    StreamTraceSource(FILE* file, StreamCodec codec, const std::string& prefix);
+    ~StreamTraceSource() override;
+    size_t nextBlock(p2AddrTr* records, size_t maxRecords) override;
+    std::string error() const override;
+
+private:
+    void produce();
+    bool readInput(std::vector<char>& buf, size_t& len);
+    bool emit(const char* data, size_t len);
+    void pushBlock(std::vector<p2AddrTr>& block);
+
+    FILE* file;
+    StreamCodec codec;
+    std::string prefix;
+    bool swapBytes;
+
+    // Partially filled block being built by the producer, as raw bytes.
+    std::vector<char> pending;
+    size_t pendingLen = 0;
+
+    mutable std::mutex lock;
+    std::condition_variable ready;
+    std::condition_variable space;
+    std::deque<std::vector<p2AddrTr>> blocks;
+    std::vector<std::vector<p2AddrTr>> spare;
+    bool finished = false;
+    bool stopping = false;
+    std::string failure;
+
+    std::vector<p2AddrTr> current;
+    size_t currentPos = 0;
+
+    std::thread worker;
+};
+
+/**
+ * @brief Look at the first bytes of a stream and pick its codec.
+ */
+StreamCodec sniffCodec(const unsigned char* magic, size_t len);
+
+#endif // STREAM_TRACE_H
@@ -0,0 +1,67 @@
+// trace_source.cpp
+#include "trace_source.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <sys/stat.h>
+#include "compact_trace.h"
+#include "stream_trace.h"
+
+using namespace std;
+
+RawTraceSource::~RawTraceSource() {
+    fclose(file);
+}
+
+size_t RawTraceSource::nextBlock(p2AddrTr* records, size_t maxRecords) {
+    return NextAddressBlock(file, records, maxRecords);
+}
+
+size_t TraceSource::skip(size_t records) {
+    vector<p2AddrTr> block(TRACE_BLOCK_RECORDS);
+    size_t skipped = 0;
+    while (skipped < records) {
+        size_t n = nextBlock(block.data(), min(block.size(), records - skipped));
+        if (n == 0) break;
+        skipped += n;
+    }
+    return skipped;
+}
+
+// Seek over whole records when the trace is a regular file.
+size_t RawTraceSource::skip(size_t records) {
+    struct stat st;
+    long position = ftell(file);
+    if (position < 0 || fstat(fileno(file), &st) != 0 || !S_ISREG(st.st_mode)) {
+        return TraceSource::skip(records);
+    }
+    size_t available = (st.st_size - position) / sizeof(p2AddrTr);
+    size_t skipped = min(records, available);
+    if (fseek(file, (long) (skipped * sizeof(p2AddrTr)), SEEK_CUR) != 0) {
+        return TraceSource::skip(records);
+    }
+    return skipped;
+}
+
+TraceSource* openTraceSource(const string& path) {
+    bool fromStdin = path == "-";
+    FILE* file = fromStdin ? stdin : fopen(path.c_str(), "rb");
+    if (!file) return nullptr;
+
+    unsigned char magic[sizeof(COMPACT_TRACE_MAGIC)];
+    size_t got = fread(magic, 1, sizeof(magic), file);
+    if (got == sizeof(magic) && memcmp(magic, COMPACT_TRACE_MAGIC, sizeof(magic)) == 0) {
+        // Compact traces are mmap'd and so must be regular files.
+        if (fromStdin) return nullptr;
+        fclose(file);
+        return CompactTraceSource::open(path);
+    }
+
+    StreamCodec codec = sniffCodec(magic, got);
+    if (codec != CODEC_NONE || fromStdin) {
+        return new StreamTraceSource(file, codec, string(reinterpret_cast<char*>(magic), got));
+    }
+
+    rewind(file);
+    return new RawTraceSource(file);
+}
@@ -0,0 +1,59 @@
+// trace_source.h
+#ifndef TRACE_SOURCE_H
+#define TRACE_SOURCE_H
+
+#include <cstdio>
+#include <string>
+#include "vaddr_tracereader.h"
+
+// Records handed to the simulator per read.
+const size_t TRACE_BLOCK_RECORDS = 4096;
+
+/*
+ * A stream of trace records. Every input format decodes into blocks of
+ * p2AddrTr so the simulation loop does not care where records come from.
+ */
+class TraceSource {
+public:
+    virtual ~TraceSource() {}
+
+    // Fill up to maxRecords records; returns 0 at end of trace.
+    virtual size_t nextBlock(p2AddrTr* records, size_t maxRecords) = 0;
+
+    // Number of low address bits the source cannot reproduce. Traces that
+    // dropped page offsets can only drive page sizes at least this large.
+    virtual unsigned int granularityBits() const { return 0; }
+
+    // Non-empty if the trace ended because it could not be decoded.
+    virtual std::string error() const { return ""; }
+
+    // Discard the next records, e.g. those already simulated before a
+    // checkpoint. Returns how many were skipped, fewer at end of trace.
+    virtual size_t skip(size_t records);
+
+    // Whether record times carry trace timestamps (ticks since the
+    // previous record) that can drive tick-based aging.
+    virtual bool hasTimestamps() const { return true; }
+};
+
+/* Raw p2AddrTr trace read with fread. */
+class RawTraceSource : public TraceSource {
+public:
+    explicit RawTraceSource(FILE* file) : file(file) {}
+    ~RawTraceSource() override;
+    size_t nextBlock(p2AddrTr* records, size_t maxRecords) override;
+    size_t skip(size_t records) override;
+
+private:
+    FILE* file;
+};
+
+/**
+ * @brief Open a trace, picking the reader from the file contents.
+ *        "-" reads from stdin; gzip and zstd input is decompressed on a
+ *        background thread.
+ * @return nullptr if the file cannot be opened or is malformed
+ */
+TraceSource* openTraceSource(const std::string& path);
+
+#endif // TRACE_SOURCE_H
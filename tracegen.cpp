@@ -0,0 +1,177 @@
+// tracegen.cpp
+// Synthetic trace generator writing p2AddrTr records readable by NextAddress.
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include <random>
+#include "vaddr_tracereader.h"
+
+using namespace std;
+
+enum Pattern { SEQ, STRIDE, UNIFORM, ZIPF, PHASE };
+
+static void usage(const char* prog) {
+    cerr << "usage: " << prog << " <seq|stride|uniform|zipf|phase> <records> <out.tr>" << endl
+         << "  -p pages      footprint in pages (default 65536)" << endl
+         << "  -z bytes      page size used to lay out the footprint (default 4096)" << endl
+         << "  -s bytes      stride for the stride pattern (default 8192)" << endl
+         << "  -t theta      Zipf skew, 0 < theta < 1 (default 0.99)" << endl
+         << "  -P records    phase length for the phase pattern (default 100000)" << endl
+         << "  -w fraction   fraction of MEMWRITE records (default 0)" << endl
+         << "  -r seed       random seed (default 1)" << endl;
+}
+
+// Zipf sampler after Gray et al., "Quickly Generating Billion-Record
+// Synthetic Databases": O(n) setup, O(1) per sample.
+class ZipfSampler {
+public:
+    ZipfSampler(uint64_t n, double theta) : n(n), theta(theta) {
+        double zeta2 = 1.0 + pow(0.5, theta);
+        zetan = 0;
+        for (uint64_t i = 1; i <= n; i++)
+            zetan += 1.0 / pow((double) i, theta);
+        alpha = 1.0 / (1.0 - theta);
+        eta = (1.0 - pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta2 / zetan);
+        halfPowTheta = 1.0 + pow(0.5, theta);
+    }
+
+    template <class Rng>
+    uint64_t next(Rng& rng) {
+        double u = uniform_real_distribution<double>(0.0, 1.0)(rng);
+        double uz = u * zetan;
+        if (uz < 1.0) return 0;
+        if (uz < halfPowTheta) return 1;
+        uint64_t rank = (uint64_t) (n * pow(eta * u - eta + 1.0, alpha));
+        return rank < n ? rank : n - 1;
+    }
+
+private:
+    uint64_t n;
+    double theta, zetan, alpha, eta, halfPowTheta;
+};
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        usage(argv[0]);
+        return 1;
+    }
+    string pattern = argv[1];
+    uint64_t records = strtoull(argv[2], nullptr, 10);
+    string outFile = argv[3];
+
+    uint64_t pages = 65536;
+    uint64_t pageSize = 4096;
+    uint64_t stride = 8192;
+    double theta = 0.99;
+    uint64_t phaseLen = 100000;
+    double writeFraction = 0.0;
+    unsigned long seed = 1;
+
+    for (int i = 4; i + 1 < argc; i += 2) {
+        string arg = argv[i];
+        if (arg == "-p") pages = strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "-z") {
+            pageSize = strtoull(argv[i + 1], nullptr, 10);
+            // Offsets are whole 4-byte words within the page
+            if (pageSize < 4 || (pageSize & (pageSize - 1)) != 0) {
+                cerr << "Page size must be a power of two of at least 4 bytes" << endl;
+                return 1;
+            }
+        }
+        else if (arg == "-s") stride = strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "-t") theta = atof(argv[i + 1]);
+        else if (arg == "-P") phaseLen = strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "-w") writeFraction = atof(argv[i + 1]);
+        else if (arg == "-r") seed = strtoul(argv[i + 1], nullptr, 10);
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    Pattern kind;
+    if (pattern == "seq") kind = SEQ;
+    else if (pattern == "stride") kind = STRIDE;
+    else if (pattern == "uniform") kind = UNIFORM;
+    else if (pattern == "zipf") kind = ZIPF;
+    else if (pattern == "phase") kind = PHASE;
+    else {
+        usage(argv[0]);
+        return 1;
+    }
+    if (pages < 2 || pages > (1ULL << 32) / pageSize ||
+        phaseLen == 0 || theta <= 0 || theta >= 1) {
+        cerr << "Footprint must fit in 32 bits and parameters must be in range" << endl;
+        return 1;
+    }
+
+    FILE* out = fopen(outFile.c_str(), "wb");
+    if (!out) {
+        cerr << "Unable to open " << outFile << endl;
+        return 1;
+    }
+
+    mt19937_64 rng(seed);
+    uniform_int_distribution<uint64_t> pageDist(0, pages - 1);
+    uniform_int_distribution<uint64_t> offsetDist(0, pageSize / 4 - 1);
+    uniform_real_distribution<double> writeDist(0.0, 1.0);
+    ZipfSampler* zipf = (kind == ZIPF || kind == PHASE) ? new ZipfSampler(pages, theta) : nullptr;
+
+    const uint64_t footprint = pages * pageSize;
+    const size_t blockRecords = 1 << 16;
+    vector<p2AddrTr> block(blockRecords);
+    uint64_t cursor = 0;
+
+    for (uint64_t done = 0; done < records;) {
+        size_t n = (size_t) min<uint64_t>(blockRecords, records - done);
+        for (size_t k = 0; k < n; k++) {
+            uint64_t idx = done + k;
+            uint64_t addr;
+            Pattern current = kind;
+            uint64_t region = 0;
+            if (kind == PHASE) {
+                // Rotate through access patterns, each over a shifted region,
+                // so the working set changes abruptly at every phase.
+                static const Pattern phases[] = {ZIPF, SEQ, UNIFORM, STRIDE};
+                uint64_t phase = idx / phaseLen;
+                current = phases[phase % 4];
+                region = (phase * footprint / 8) % footprint;
+            }
+
+            if (current == SEQ) {
+                addr = cursor;
+                cursor = (cursor + 4) % footprint;
+            } else if (current == STRIDE) {
+                addr = cursor;
+                cursor = (cursor + stride) % footprint;
+            } else if (current == UNIFORM) {
+                addr = pageDist(rng) * pageSize + offsetDist(rng) * 4;
+            } else {
+                addr = zipf->next(rng) * pageSize + offsetDist(rng) * 4;
+            }
+            addr = (addr + region) % footprint;
+
+            p2AddrTr& rec = block[k];
+            rec.addr = (uint32_t) addr;
+            rec.reqtype = (writeFraction > 0 && writeDist(rng) < writeFraction) ? MEMWRITE : MEMREAD;
+            rec.size = 4;
+            rec.attr = 0;
+            rec.proc = 0;
+            rec.time = 1;  // ticks since the previous record
+        }
+        if (fwrite(block.data(), sizeof(p2AddrTr), n, out) != n) {
+            cerr << "Write to " << outFile << " failed" << endl;
+            fclose(out);
+            return 1;
+        }
+        done += n;
+    }
+
+    delete zipf;
+    fclose(out);
+    return 0;
+}
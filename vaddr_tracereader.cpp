@@ -69,6 +69,31 @@ int NextAddress(FILE *trace_file, p2AddrTr *addr_ptr) {
   return readN;    
 }
 
+/* size_t NextAddressBlock(FILE *trace_file, p2AddrTr *Addr, size_t max_records)
+ * Fetch up to max_records addresses from the trace with a single read.
+ *
+ * Same contract as NextAddress, but populates an array of address
+ * structures and returns the number of records stored.
+ */
+size_t NextAddressBlock(FILE *trace_file, p2AddrTr *addr_ptr, size_t max_records) {
+
+  size_t readN;	/* number of records stored */
+  /* initialized once, safely, even when several readers run at once */
+  static const ENDIAN byte_order = endian();
+
+  readN = fread(addr_ptr, sizeof(p2AddrTr), max_records, trace_file);
+
+  if (byte_order == BIG) {
+    /* records stored in little endian format, convert */
+    for (size_t i = 0; i < readN; i++) {
+      addr_ptr[i].addr = swap_endian(addr_ptr[i].addr);
+      addr_ptr[i].time = swap_endian(addr_ptr[i].time);
+    }
+  }
+
+  return readN;
+}
+
 /* void AddressDecoder(p2AddrTr *addr_ptr, FILE *out)
  * Decode a Pentium II BYU address and print to the specified
  * file handle (opened by fopen in write mode)
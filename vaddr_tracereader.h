@@ -1,3 +1,6 @@
+#ifndef VADDR_TRACEREADER_H
+#define VADDR_TRACEREADER_H
+
 
 /* C and C++ define some of their types in different places.
  * Check and see if we are using C or C++ and include appropriately
@@ -29,11 +32,22 @@ typedef enum {
 } ENDIAN;
 
 
+/* endian - Determine if this machine is big- or little- endian */
+ENDIAN endian();
+
+/* swap_endian - Reverse the byte order of a 32 bit value */
+uint32_t swap_endian(uint32_t num);
+
 /* NextAddress - Fetch the next address from the trace.
  * See byu_tracereader.c for details.
  */
 int NextAddress(FILE *trace_file, p2AddrTr *addr_ptr);
 
+/* NextAddressBlock - Fetch up to max_records addresses from the trace.
+ * Returns the number of records stored, 0 at end of trace.
+ */
+size_t NextAddressBlock(FILE *trace_file, p2AddrTr *addr_ptr, size_t max_records);
+
 /* reqtype values */
 #define FETCH			0x00	// instruction fetch
 #define MEMREAD			0x01	// memory read
@@ -57,3 +71,4 @@ int NextAddress(FILE *trace_file, p2AddrTr *addr_ptr);
 #define SMIACK			0x37	// acknowledge SMI mode
 						
 
+#endif /* VADDR_TRACEREADER_H */